@@ -174,6 +174,7 @@ Int_t SciFi::ReadDatabase( const TDatime& date )
   fNSB = 1;  //number of integration samples before threshold crossing
   fWin = 1;  //total number of sample in FADC window
   fTFlag = 1;  //Threshold On: 1, Off: 0
+  fTET = 0;    //FADC threshold (raw sample value) for raw-sample modes
   
   fno_x_hits = 0;
   fno_y_hits = 0;
@@ -190,12 +191,14 @@ Int_t SciFi::ReadDatabase( const TDatime& date )
     { "NSB",              &fNSB,         kInt},
     { "Win",              &fWin,         kInt},
     { "TFlag",            &fTFlag,       kInt},
+    { "TET",              &fTET,         kInt},
     { 0 }
   };
   err = LoadDB( file, date, calib_request, fPrefix );
   fclose(file);
   if( err )
     return err;
+  fPulse.Configure( fNPED, fNSB, fNSA, fTET );
 
 
   if( !fIsInit ) {
@@ -596,7 +599,7 @@ Int_t SciFi::Decode( const THaEvData& evdata )
 
     mode = fFADC->GetFadcMode();
 
-    raw_mode = (mode == 1) || (mode == 8) || (mode == 10);
+    raw_mode = TriFadcPulse::IsRawMode(mode);
 
     //    std::cout << "Fadc mode is " << mode << std::endl;
 
@@ -646,7 +649,9 @@ Int_t SciFi::Decode( const THaEvData& evdata )
 	
 	
 	
-	if(!raw_mode){
+	// In the raw-sample modes the pulse quantities come from the
+	// software pulse analysis, otherwise from the FADC
+	{
 	  
 //		cout << "fAHits[k] [" << k << "] = fFADC->GetNumFadcEvents(chan) =  (" << chan << ") " << fFADC->GetNumFadcEvents(chan) << endl;
 
@@ -682,9 +687,20 @@ Int_t SciFi::Decode( const THaEvData& evdata )
 	
 	
 	
-	data = evdata.GetData(kPulseIntegral,d->crate,d->slot,chan,0);
-	ftime = evdata.GetData(kPulseTime,d->crate,d->slot,chan,0);
-	fpeak = evdata.GetData(kPulsePeak,d->crate,d->slot,chan,0);
+	Int_t fped;
+	if(raw_mode){
+	  fPulse.Analyze( fFADC->GetPulseSamplesVector(chan) );
+	  data = fPulse.GetIntegral();
+	  ftime = fPulse.GetTime();
+	  fpeak = fPulse.GetPeak();
+	  fped = fPulse.GetPedestal();
+	}
+	else{
+	  data = evdata.GetData(kPulseIntegral,d->crate,d->slot,chan,0);
+	  ftime = evdata.GetData(kPulseTime,d->crate,d->slot,chan,0);
+	  fpeak = evdata.GetData(kPulsePeak,d->crate,d->slot,chan,0);
+	  fped = evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0);
+	}
 
 	// }
 	// else{ 
@@ -701,6 +717,10 @@ Int_t SciFi::Decode( const THaEvData& evdata )
 	  foverflow[fibre] = fFADC->GetOverflowBit(chan,0);
 	  funderflow[fibre] = fFADC->GetUnderflowBit(chan,0);
 	  fpedq[fibre] = fFADC->GetPedestalQuality(chan,0);
+	  if(raw_mode){
+	    foverflow[fibre] = fPulse.GetOverflow();
+	    fpedq[fibre] = fPulse.GetPedestalQuality();
+	  }
 	  
 	  noevents = fFADC->GetNumFadcEvents(chan);
 	  //	fAHits[k] = fFADC->GetNumFadcEvents(chan);
@@ -714,11 +734,11 @@ Int_t SciFi::Decode( const THaEvData& evdata )
 	    //	    std::cout << " passed 100000 condition " << std::endl;
 	    if(fTFlag == 1)
 	      {
-		tempPed=(fNSA+fNSB)*(static_cast<Double_t>(evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0)))/fNPED;
+		tempPed=(fNSA+fNSB)*(static_cast<Double_t>(fped))/fNPED;
 	      }
 	    else
 	      {
-		tempPed=fWin*(static_cast<Double_t>(evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0)))/fNPED;
+		tempPed=fWin*(static_cast<Double_t>(fped))/fNPED;
 	      }
 	  }
 	
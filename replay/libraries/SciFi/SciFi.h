@@ -11,6 +11,7 @@
 
 #include "THaNonTrackingDetector.h"
 //#include "Fadc250Module.h"
+#include "TriFadcPulse.h"
 
 class TClonesArray;
 
@@ -59,6 +60,8 @@ public:
   Int_t    fNSB;         //number of integration samples before threshold crossing
   Int_t    fWin;         //total number of samples in FADC window
   Int_t    fTFlag;       //flag for FADC threshold on vs FADC threshold off
+  Int_t    fTET;         //FADC threshold (raw sample value), for raw-sample modes
+  TriFadcPulse fPulse;   //! pulse analysis of raw samples
   Int_t    mod_Err_cnt=0;// Num of err calls for module issue (BANE)
 
   // Changes: getting rid of TDC values
@@ -16,6 +16,8 @@
 #include "TTree.h"
 #include "TString.h"  
 
+class THaVar;
+
 //public THaPhysicsModule, public TriScalerEvtHandler
 class TriBCM : public THaPhysicsModule {
 
@@ -25,6 +27,7 @@ public:
    TriBCM();// for ROOT I/O
    virtual ~TriBCM();
 
+   virtual EStatus Init( const TDatime& run_time );
    virtual Int_t Process(const THaEvData& evdata);
 
   protected:
@@ -128,8 +131,16 @@ public:
   
   Bool_t Beam_status;
   
+  // Scaler variables, bound by BindVariables()
+  THaVar* clock_var;        //! Scaler clock count
+  THaVar* clock_rate_var;   //! Scaler clock rate
+  THaVar* bcm_var[8];       //! BCM counts
+  THaVar* bcm_rate_var[8];  //! BCM rates
+  THaVar* v1495_var;        //! V1495 clock count
+  Bool_t  vars_bound;       //! Variables found
   
   void           DeleteArrays();
+  Bool_t         BindVariables();
   virtual Int_t  ReadDatabase( const TDatime& date );
   virtual Int_t  DefineVariables( EMode mode = kDefine );
   virtual Int_t BeamQuality(const THaEvData& evdata);
@@ -0,0 +1,82 @@
+#ifndef HALLA_TriBeamTrip
+#define HALLA_TriBeamTrip
+
+//////////////////////////////////////////////////////////////////////////
+//
+// TriBeamTrip - beam trip cut made during the replay
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPhysicsModule.h"
+#include "TString.h"
+#include <vector>
+
+class THaVar;
+
+class TriBeamTrip : public THaPhysicsModule {
+public:
+  TriBeamTrip( const char* name, const char* description,
+	       const char* bcm_module, const char* bcm = "dnew" );
+  virtual ~TriBeamTrip();
+
+  virtual Int_t   Begin( THaRunBase* r=0 );
+  virtual Int_t   End( THaRunBase* r=0 );
+  virtual EStatus Init( const TDatime& run_time );
+  virtual Int_t   Process( const THaEvData& );
+
+protected:
+
+  // Events between two scaler readings
+  struct Interval_t {
+    Long64_t first, last;   // Event numbers
+    Double_t time;          // Length (s)
+    Double_t charge;        // Charge (uC)
+  };
+  // Stable beam current and the event ranges with beam at that current
+  struct Level_t {
+    Double_t current;       // Level (uA)
+    Double_t weight;        // Time spent near the level (s)
+    std::vector<Long64_t> first, last;
+    std::vector<Double_t> charge, time;
+  };
+
+  TString   fBCMModule;     // Name of the TriBCM module
+  TString   fBCM;           // BCM to use (u1, dnew, ...)
+
+  // Global variables, bound by BindVariables()
+  const THaVar* fChargeVar; // Charge since the last scaler reading
+  const THaVar* fRenewVar;  // Scaler reading renewed
+  const THaVar* fClockVar;  // Scaler clock count
+  Bool_t    fVarsBound;
+
+  // Configuration parameters
+  TString   fClockName;     // Global variable of the scaler clock
+  Double_t  fClockRate;     // Clock frequency (Hz)
+  Double_t  fStableTime;    // Stable beam required after a trip (s)
+  Double_t  fMinCurrent;    // Lowest current level (uA)
+  Double_t  fMaxDev;        // Largest deviation from the level (uA)
+  Double_t  fBinWidth;      // Bin width for finding the levels (uA)
+  Int_t     fMaxLevels;     // Most current levels per run
+
+  // Data of this run
+  Int_t     fRunNumber;     // Run being analyzed
+  Bool_t    fContinued;     // Started at a later split file of the run
+  Int_t     fNWrite;        // Number of times the ranges were written
+  Bool_t    fHaveStart;     // Start of the current interval is known
+  Long64_t  fStartEv;       // Its first event
+  Double_t  fStartClock;    // and clock count
+  Double_t  fCharge;        // Charge since then
+  Double_t  fGap;           // Deviation allowed, given the levels found
+  std::vector<Interval_t> fIntervals;
+  std::vector<Level_t>    fLevels;
+
+  Bool_t        BindVariables();
+  void          FindLevels();
+  void          MakeRanges();
+  void          WriteRanges();
+  virtual Int_t ReadDatabase( const TDatime& date );
+
+  ClassDef(TriBeamTrip,0)   // Beam trip cut physics module
+};
+
+#endif
@@ -11,6 +11,7 @@
 
 #include "THaPidDetector.h"
 #include "Fadc250Module.h"
+#include "TriFadcPulse.h"
 
 class TClonesArray;
 
@@ -40,6 +41,8 @@ protected:
   Int_t    fNSB;         //number of integration samples before threshold crossing
   Int_t    fWin;         //total number of samples in FADC window
   Int_t    fTFlag;       //flag for FADC threshold on vs FADC threshold off
+  Int_t    fTET;         //FADC threshold (raw sample value), for raw-sample modes
+  TriFadcPulse fPulse;   //! pulse analysis of raw samples
 
 
   // Per-event data
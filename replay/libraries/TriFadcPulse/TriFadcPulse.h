@@ -0,0 +1,193 @@
+#ifndef Podd_TriFadcPulse_h_
+#define Podd_TriFadcPulse_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// TriFadcPulse                                                              //
+//                                                                           //
+// Software version of the FADC250 pulse analysis, for channels read out     //
+// in the raw-sample modes 1, 8 and 10. From the samples of one readout      //
+// window it computes the quantities the firmware reports in modes 9/10.     //
+// It follows the firmware algorithm in integer arithmetic and, like the     //
+// firmware, uses the pedestal average truncated to an integer,              //
+// ped = (pedestal sum)/NPED. The results have not yet been checked          //
+// against mode 9/10 data.                                                   //
+//                                                                           //
+//  pedestal  sum of the first NPED samples (as kPulsePedestal)              //
+//  tc        first sample > TET. As in the firmware, TET is a raw sample    //
+//            value (the ROLs set the channel pedestal register to 0), so it //
+//            must be the faSetThreshold value of the ROL, not a height      //
+//            above pedestal. With thresholds off (TET below the baseline)   //
+//            every window crosses at its first sample.                      //
+//  integral  sum of the samples tc-NSB ... tc+NSA-1 (as kPulseIntegral)     //
+//  peak      first local maximum at or after tc (as kPulsePeak)             //
+//  time      where the leading edge crosses half way between pedestal       //
+//            and peak, in 1/64 of a sample = 62.5 ps (as kPulseTime)        //
+//                                                                           //
+// Up to kMaxPulses pulses are found per window; the search for the next     //
+// one starts after the integration window, once the signal is back at or    //
+// below threshold.                                                          //
+//                                                                           //
+// The work is done in plain loops over contiguous arrays (sample unpacking, //
+// threshold flags, running sums), which the compiler vectorizes; the pulse  //
+// quantities are then read off without rescanning the window.               //
+//                                                                           //
+// Header only, so that every Tri* FADC detector library can use it without  //
+// linking to another library. Build with -I../TriFadcPulse.                 //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <stdint.h>
+
+class TriFadcPulse {
+
+public:
+  enum { kMaxPulses = 4 };
+
+  struct Pulse {
+    Int_t  integral;   // Sum of samples in the integration window
+    Int_t  time;       // Leading edge time (1/64 sample)
+    Int_t  peak;       // Peak sample value
+    Int_t  tc;         // Sample number of the threshold crossing
+    Bool_t overflow;   // A sample in the integration window overflowed
+  };
+
+  TriFadcPulse() : fNPED(4), fNSB(3), fNSA(10), fTET(0), fMaxPed(0),
+		   fPedSum(0), fPedQ(0), fNPulses(0) {}
+
+  // Integration parameters as set in the FADC: pedestal samples, samples
+  // before and after the crossing, threshold (raw sample value), and the
+  // largest good pedestal sample (0 = no check)
+  void Configure( Int_t nped, Int_t nsb, Int_t nsa, Int_t tet,
+		  Int_t maxped = 0 ) {
+    fNPED = (nped > 0) ? nped : 1;
+    fNSB = nsb; fNSA = nsa; fTET = tet; fMaxPed = maxped;
+  }
+
+  // FADC modes that deliver the raw samples
+  static Bool_t IsRawMode( Int_t mode ) {
+    return (mode == 1) || (mode == 8) || (mode == 10);
+  }
+
+  Int_t Analyze( const std::vector<uint32_t>& samples ) {
+    return Analyze( samples.empty() ? 0 : &samples[0], samples.size() );
+  }
+  inline Int_t Analyze( const uint32_t* samples, Int_t n );
+
+  Int_t        GetNPulses() const         { return fNPulses; }
+  Int_t        GetPedestal() const        { return fPedSum; }
+  Int_t        GetPedestalQuality() const { return fPedQ; }
+  const Pulse& GetPulse( Int_t i ) const  { return fPulse[i]; }
+
+  // Pulse quantities of pulse i, 0 if there is no such pulse
+  Int_t GetIntegral( Int_t i = 0 ) const { return (i<fNPulses) ? fPulse[i].integral : 0; }
+  Int_t GetTime( Int_t i = 0 ) const     { return (i<fNPulses) ? fPulse[i].time : 0; }
+  Int_t GetPeak( Int_t i = 0 ) const     { return (i<fNPulses) ? fPulse[i].peak : 0; }
+  Int_t GetOverflow( Int_t i = 0 ) const { return (i<fNPulses) ? fPulse[i].overflow : 0; }
+
+protected:
+  Int_t  fNPED, fNSB, fNSA, fTET, fMaxPed;   // Configuration
+
+  // Results of the last window
+  Int_t  fPedSum;                // Pedestal sum of the first NPED samples
+  Int_t  fPedQ;                  // Pedestal quality, 0 = good
+  Int_t  fNPulses;               // Number of pulses found
+  Pulse  fPulse[kMaxPulses];
+
+  // Workspace, one entry per sample
+  std::vector<Int_t>   fS;       // Sample values
+  std::vector<Int_t>   fCum;     // fCum[i] = sum of fS[0..i-1]
+  std::vector<Int_t>   fOvfCum;  // Number of overflows in samples 0..i-1
+  std::vector<UChar_t> fAbove;   // Sample above threshold
+};
+
+//_____________________________________________________________________________
+inline Int_t TriFadcPulse::Analyze( const uint32_t* samples, Int_t n )
+{
+  // Analyze one readout window of n samples as delivered by the decoder
+  // (13 bits, bit 12 being the overflow bit). Returns the number of
+  // pulses found.
+
+  fNPulses = 0;
+  fPedSum = 0;
+  fPedQ = 1;
+  if( n < fNPED )
+    return 0;
+
+  fS.resize(n);
+  fCum.resize(n+1);
+  fOvfCum.resize(n+1);
+  fAbove.resize(n);
+  Int_t* s = &fS[0];
+  Int_t* cum = &fCum[0];
+  Int_t* ovf = &fOvfCum[0];
+  UChar_t* above = &fAbove[0];
+
+  // Unpack; an overflowed sample reads as full scale
+  for( Int_t i = 0; i < n; i++ ) {
+    Int_t v = samples[i] & 0x1FFF;
+    s[i] = (v > 0xFFF) ? 0xFFF : v;
+  }
+  cum[0] = ovf[0] = 0;
+  for( Int_t i = 0; i < n; i++ ) {
+    cum[i+1] = cum[i] + s[i];
+    ovf[i+1] = ovf[i] + ((samples[i] & 0x1000) != 0);
+  }
+
+  // Pedestal. As in the firmware, the half height of the leading edge
+  // uses the pedestal average, truncated to an integer.
+  const Int_t N = fNPED;
+  fPedSum = cum[N];
+  fPedQ = (ovf[N] != 0);
+  if( fMaxPed > 0 )
+    for( Int_t i = 0; i < N; i++ )
+      fPedQ |= (s[i] > fMaxPed);
+  const Int_t ped = fPedSum / N;
+
+  // Threshold crossings; TET is compared with the raw samples
+  for( Int_t i = 0; i < n; i++ )
+    above[i] = (s[i] > fTET);
+
+  Int_t i = 0, prev_end = 0;
+  while( fNPulses < kMaxPulses ) {
+    for( ; i < n && !above[i]; i++ ) ;
+    if( i >= n )
+      break;
+    Pulse& p = fPulse[fNPulses++];
+    const Int_t tc = i;
+
+    // First local maximum
+    Int_t ip = tc;
+    while( ip+1 < n && s[ip+1] >= s[ip] )
+      ip++;
+
+    // Integration window, not overlapping the previous pulse's
+    Int_t lo = tc - fNSB, hi = tc + fNSA;
+    if( lo < prev_end ) lo = prev_end;
+    if( hi > n ) hi = n;
+
+    // Half way between pedestal and peak, truncated; the last sample
+    // before the peak below it and the one after bracket the crossing
+    const Int_t vmid = (s[ip] + ped) / 2;
+    Int_t k = ip-1;
+    while( k >= 0 && s[k] >= vmid )
+      k--;
+    Int_t time = 0;
+    if( k >= 0 && s[k+1] > s[k] )
+      time = 64*k + (64*(vmid - s[k])) / (s[k+1] - s[k]);
+
+    p.integral = cum[hi] - cum[lo];
+    p.time     = time;
+    p.peak     = s[ip];
+    p.tc       = tc;
+    p.overflow = (ovf[hi] != ovf[lo]);
+
+    prev_end = hi;
+    for( i = hi; i < n && above[i]; i++ ) ;
+  }
+  return fNPulses;
+}
+
+#endif
@@ -217,6 +217,7 @@ Int_t TriFadcScin::ReadDatabase( const TDatime& date )
   fNSB = 1;  //number of integrated samples before threshold crossing
   fWin = 1;  //total number of sample in FADC window
   fTFlag = 1;  //Threshold On: 1, Off: 0
+  fTET = 0;    //FADC threshold (raw sample value) for raw-sample modes
 
   // Default TDC offsets (0), ADC pedestals (0) and ADC gains (1)
   memset( fLOff, 0, nval*sizeof(fLOff[0]) );
@@ -244,12 +245,14 @@ Int_t TriFadcScin::ReadDatabase( const TDatime& date )
     { "NSB",              &fNSB,         kInt},
     { "Win",              &fWin,         kInt},
     { "TFlag",            &fTFlag,       kInt},
+    { "TET",              &fTET,         kInt},
     { 0 }
   };
   err = LoadDB( file, date, calib_request, fPrefix );
   fclose(file); 
   if( err )
     return err;
+  fPulse.Configure( fNPED, fNSB, fNSA, fTET );
 
   if( fResolution == kBig )
     fResolution = fTdc2T;
@@ -436,6 +439,7 @@ Int_t TriFadcScin::Decode( const THaEvData& evdata )
     bool adc = ( d->model ? fDetMap->IsADC(d) : (i < fDetMap->GetSize()/2) );
     
     if(adc) fFADC = dynamic_cast <Fadc250Module*> (evdata.GetModule(d->crate, d->slot));
+    Bool_t raw_mode = adc && fFADC && TriFadcPulse::IsRawMode(fFADC->GetFadcMode());
    
     // Loop over all channels that have a hit.
     for( Int_t j = 0; j < evdata.GetNumChan( d->crate, d->slot ); j++) {
@@ -465,11 +469,20 @@ Int_t TriFadcScin::Decode( const THaEvData& evdata )
       int jj=k/fNelem; 
       k = k % fNelem; 
 
-      Int_t data,ftime=0,fpeak=0;
-      if(adc){
+      Int_t data,ftime=0,fpeak=0,fped=0;
+      if(raw_mode){
+         // Raw samples: do the pulse analysis in software
+         fPulse.Analyze( fFADC->GetPulseSamplesVector(chan) );
+         data  = fPulse.GetIntegral();
+         ftime = fPulse.GetTime();
+         fpeak = fPulse.GetPeak();
+         fped  = fPulse.GetPedestal();
+      }
+      else if(adc){
          data = evdata.GetData(kPulseIntegral,d->crate,d->slot,chan,0);
          ftime = evdata.GetData(kPulseTime,d->crate,d->slot,chan,0);
          fpeak = evdata.GetData(kPulsePeak,d->crate,d->slot,chan,0);
+         fped = evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0);
       }
       else {
 	     if(jj==0){
@@ -489,6 +502,10 @@ Int_t TriFadcScin::Decode( const THaEvData& evdata )
                   floverflow[k] = fFADC->GetOverflowBit(chan,0);
                   flunderflow[k] = fFADC->GetUnderflowBit(chan,0);
                   flpedq[k] = fFADC->GetPedestalQuality(chan,0);
+                  if(raw_mode){
+                    floverflow[k] = fPulse.GetOverflow();
+                    flpedq[k] = fPulse.GetPedestalQuality();
+                  }
                   fLPeak[k]=static_cast<Double_t>(fpeak);
                   fLT_FADC[k]=static_cast<Double_t>(ftime);
 		  fLT_FADC_c[k]=fLT_FADC[k]*0.0625;
@@ -497,6 +514,10 @@ Int_t TriFadcScin::Decode( const THaEvData& evdata )
                   froverflow[k]=fFADC->GetOverflowBit(chan,0);
                   frunderflow[k]=fFADC->GetUnderflowBit(chan,0);
                   frpedq[k]=fFADC->GetPedestalQuality(chan,0);
+                  if(raw_mode){
+                    froverflow[k] = fPulse.GetOverflow();
+                    frpedq[k] = fPulse.GetPedestalQuality();
+                  }
                   fRPeak[k]=static_cast<Double_t>(fpeak);
                   fRT_FADC[k]=static_cast<Double_t>(ftime);
 		  fRT_FADC_c[k]=fRT_FADC[k]*0.0625;
@@ -507,11 +528,11 @@ Int_t TriFadcScin::Decode( const THaEvData& evdata )
          {
            if(fTFlag == 1)
            {
-             dest->ped[k]=(fNSA+fNSB)*(static_cast<Double_t>(evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0)))/fNPED;
+             dest->ped[k]=(fNSA+fNSB)*(static_cast<Double_t>(fped))/fNPED;
            }
            else
            {
-             dest->ped[k]=fWin*(static_cast<Double_t>(evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0)))/fNPED;
+             dest->ped[k]=fWin*(static_cast<Double_t>(fped))/fNPED;
            }
          }
       }
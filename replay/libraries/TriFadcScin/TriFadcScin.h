@@ -9,6 +9,7 @@
 
 #include "THaNonTrackingDetector.h"
 #include "Fadc250Module.h"
+#include "TriFadcPulse.h"
 
 class THaScCalib;
 class TClonesArray;
@@ -82,6 +83,8 @@ protected:
   Int_t       fNSB;         //number of integrated samples before threshold crossing
   Int_t       fWin;         //total number of samples in FADC window
   Int_t       fTFlag;       //flag for FADC threshold on vs FADC threshold off
+  Int_t       fTET;         //FADC threshold (raw sample value), for raw-sample modes
+  TriFadcPulse fPulse;      //! pulse analysis of raw samples
 
   // Per-event data
   Int_t       fLTNhit;     // Number of Left paddles TDC times
@@ -6,9 +6,11 @@
 // Shujie Li, 08.2018                                                         //
 // describing a generic segmented shower detector                             //
 // (preshower or shower).                                                    //
-// Currently, only the "main" cluster, i.e. cluster with the largest energy  //
-// deposition is considered. Units of measurements are MeV for energy of     //
-// shower and centimeters for coordinates.                                   //
+// Every local energy maximum above emin seeds a cluster of itself and its   //
+// neighbours. The "main" cluster, i.e. cluster with the largest energy      //
+// deposition, is also kept in the single-cluster variables. Units of        //
+// measurements are MeV for energy of shower and centimeters for             //
+// coordinates.                                                              //
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -39,7 +41,8 @@ TriFadcShower::TriFadcShower( const char* name, const char* description,
 		      THaApparatus* apparatus ) :
   THaPidDetector(name,description,apparatus),
   fNclublk(0), fNrows(0), fBlockX(0), fBlockY(0), fPed(0), fGain(0),
-  fNhits(0), fA(0), fA_p(0), fA_c(0), fNblk(0), fEblk(0), foverflow(0), funderflow(0), fpedq(0),
+  fNhits(0), fA(0), fA_p(0), fA_c(0), fNblk(0), fEblk(0),
+  fClE(0), fClX(0), fClY(0), fClMult(0), foverflow(0), funderflow(0), fpedq(0),
   fPeak(0),fT(0),fT_c(0)
 {
   // Constructor
@@ -49,7 +52,8 @@ TriFadcShower::TriFadcShower( const char* name, const char* description,
 TriFadcShower::TriFadcShower() :
   THaPidDetector(),
   fNclublk(0), fNrows(0), fBlockX(0), fBlockY(0), fPed(0), fGain(0),
-  fNhits(0), fA(0), fA_p(0), fA_c(0), fNblk(0), fEblk(0), fPeak(0),fT(0),fT_c(0)
+  fNhits(0), fA(0), fA_p(0), fA_c(0), fNblk(0), fEblk(0),
+  fClE(0), fClX(0), fClY(0), fClMult(0), fPeak(0),fT(0),fT_c(0)
 {
   // Default constructor (for ROOT I/O)
 }
@@ -84,6 +88,7 @@ Int_t TriFadcShower::ReadDatabase( const TDatime& date )
   fNPED = 1;
   fNSA  = 1;
   fNSB  = 1;
+  fTET  = 0;
   DBRequest config_request[] = {
     { "detmap",       &detmap,  kIntV },
     { "chanmap",      &chanmap, kIntV,    0, 1 },
@@ -96,9 +101,11 @@ Int_t TriFadcShower::ReadDatabase( const TDatime& date )
     { "NSA",          &fNSA,    kInt},
     { "NSB",          &fNSB,    kInt},
     { "TFlag",       &fTFlag,    kInt},
+    { "TET",          &fTET,    kInt},  // FADC threshold, as in the ROL
     { 0 }
   };
   err = LoadDB( file, date, config_request, fPrefix );
+  fPulse.Configure( fNPED, fNSB, fNSA, fTET );
  
 
   // Sanity checks
@@ -195,6 +202,10 @@ Int_t TriFadcShower::ReadDatabase( const TDatime& date )
     fA_c  = new Float_t[ nval ];
     fNblk = new Int_t[ fNclublk ];
     fEblk = new Float_t[ fNclublk ];
+    fClE    = new Float_t[ nval ];
+    fClX    = new Float_t[ nval ];
+    fClY    = new Float_t[ nval ];
+    fClMult = new Int_t[ nval ];
     fPeak = new Float_t[ nval ];
     fT    = new Float_t[ nval ];
     fT_c  = new Float_t[ nval ];
@@ -216,6 +227,7 @@ Int_t TriFadcShower::ReadDatabase( const TDatime& date )
       fBlockY[k] = xy[1] + c*dxy[1];
     }
   }
+  BuildNeighbours( ncols );
 
   // Read calibration parameters
 
@@ -261,6 +273,35 @@ Int_t TriFadcShower::ReadDatabase( const TDatime& date )
   return kOK;
 }
 
+//_____________________________________________________________________________
+void TriFadcShower::BuildNeighbours( Int_t ncols )
+{
+  // Tabulate the (up to 8) neighbours of each block, so that the cluster
+  // finder never has to convert block numbers to rows and columns.
+  // Block k is in column k/fNrows and row k%fNrows.
+
+  fNbStart.assign( fNelem+1, 0 );
+  fNbList.clear();
+  for( int c=0; c<ncols; c++ ) {
+    for( int r=0; r<fNrows; r++ ) {
+      int k = fNrows*c + r;
+      fNbStart[k] = fNbList.size();
+      for( int ic=c-1; ic<=c+1; ic++ ) {
+	if( ic < 0 || ic >= ncols ) continue;
+	for( int ir=r-1; ir<=r+1; ir++ ) {
+	  if( ir < 0 || ir >= fNrows || (ic == c && ir == r) ) continue;
+	  fNbList.push_back( fNrows*ic + ir );
+	}
+      }
+    }
+  }
+  fNbStart[fNelem] = fNbList.size();
+
+  fBlkE.assign( fNelem, 0 );
+  fBlkClust.assign( fNelem, -1 );
+  fMaxBlk.reserve( fNelem );
+}
+
 //_____________________________________________________________________________
 Int_t TriFadcShower::DefineVariables( EMode mode )
 {
@@ -288,6 +329,10 @@ Int_t TriFadcShower::DefineVariables( EMode mode )
     { "mult",   "Multiplicity of largest cluster",    "fMult" },
     { "nblk",   "Numbers of blocks in main cluster",  "fNblk" },
     { "eblk",   "Energies of blocks in main cluster", "fEblk" },
+    { "cl_e",   "Energies (MeV) of all clusters",     "fClE" },
+    { "cl_x",   "x-positions (cm) of all clusters",   "fClX" },
+    { "cl_y",   "y-positions (cm) of all clusters",   "fClY" },
+    { "cl_mult","Multiplicities of all clusters",     "fClMult" },
     { "trx",    "x-position of track in det plane",   "fTrackProj.THaTrackProj.fX" },
     { "try",    "y-position of track in det plane",   "fTrackProj.THaTrackProj.fY" },
     { "trpath", "TRCS pathlen of track to det plane", "fTrackProj.THaTrackProj.fPathl" },
@@ -330,6 +375,10 @@ void TriFadcShower::DeleteArrays()
   delete [] fT_c;     fT_c     = 0;
   delete [] fNblk;    fNblk    = 0;
   delete [] fEblk;    fEblk    = 0;
+  delete [] fClE;     fClE     = 0;
+  delete [] fClX;     fClX     = 0;
+  delete [] fClY;     fClY     = 0;
+  delete [] fClMult;  fClMult  = 0;
   delete [] foverflow; foverflow = 0;
   delete [] funderflow; funderflow = 0;
   delete [] fpedq;    fpedq    = 0;
@@ -350,6 +399,7 @@ void TriFadcShower::Clear( Option_t* opt )
   }
  
 
+  fHitBlk.clear();
   fAsum_p = fAsum_c = 0.0;
   fE = fX = fY = kBig;
   memset( fNblk, 0, fNclublk*sizeof(fNblk[0]) );
@@ -392,6 +442,7 @@ Int_t TriFadcShower::Decode( const THaEvData& evdata )
     THaDetMap::Module* d = fDetMap->GetModule( i );
     Fadc250Module *fFADC;
     fFADC = dynamic_cast <Fadc250Module*> (evdata.GetModule(d->crate, d->slot));
+    Bool_t raw_mode = fFADC && TriFadcPulse::IsRawMode(fFADC->GetFadcMode());
 
     // fFADC = dynamic_cast<Fadc250Module*>(evdata.GetModule(d->crate, d->slot));
 
@@ -453,6 +504,16 @@ Int_t TriFadcShower::Decode( const THaEvData& evdata )
         fpedq[k]      = fFADC->GetPedestalQuality(chan,0);
 	fFADCped[k]  = evdata.GetData(kPulsePedestal,d->crate,d->slot,chan,0);
       }
+      if( raw_mode ) {
+	// Raw samples: do the pulse analysis in software
+	fPulse.Analyze( fFADC->GetPulseSamplesVector(chan) );
+	data  = fPulse.GetIntegral();
+	ftime = fPulse.GetTime();
+	fpeak = fPulse.GetPeak();
+	foverflow[k] = fPulse.GetOverflow();
+	fpedq[k]     = fPulse.GetPedestalQuality();
+	fFADCped[k]  = fPulse.GetPedestal();
+      }
       
       if(fpedq[k]==0) // good quality
 	{
@@ -482,6 +543,7 @@ Int_t TriFadcShower::Decode( const THaEvData& evdata )
       fT[k]=static_cast<Float_t>(ftime);
       fT_c[k]=fT[k]*0.0625;
 
+      fHitBlk.push_back(k);
       fNhits++;
     }
   }
@@ -520,6 +582,95 @@ Int_t TriFadcShower::Decode( const THaEvData& evdata )
   return fNhits;
 }
 
+//_____________________________________________________________________________
+void TriFadcShower::FindClusters()
+{
+  // Find all clusters among the blocks hit in this event.
+  //
+  // Every hit block with energy above fEmin and above that of all its
+  // neighbours is a cluster center (on equal energies, the lower block
+  // number wins). Clusters are made in order of decreasing center energy
+  // from the center and those of its neighbours with energy that are not
+  // yet in a cluster, so a block between two centers goes to the higher
+  // one. Only hit blocks and their neighbours are visited.
+
+  fNclust = 0;
+  fMaxBlk.clear();
+  const Int_t nhit = fHitBlk.size();
+  for( Int_t i = 0; i < nhit; i++ )
+    fBlkE[fHitBlk[i]] = fA_c[fHitBlk[i]];
+
+  for( Int_t i = 0; i < nhit; i++ ) {
+    Int_t k = fHitBlk[i];
+    Float_t ek = fBlkE[k];
+    if( !(ek > fEmin) ) continue;
+    bool ismax = true;
+    for( Int_t j = fNbStart[k]; j < fNbStart[k+1] && ismax; j++ ) {
+      Int_t n = fNbList[j];
+      if( fBlkE[n] > ek || (fBlkE[n] == ek && n < k) )
+	ismax = false;
+    }
+    if( !ismax ) continue;
+    // Insert, keeping the centers sorted by decreasing energy
+    Int_t m = fMaxBlk.size();
+    fMaxBlk.push_back(k);
+    for( ; m > 0 && fBlkE[fMaxBlk[m-1]] < ek; m-- )
+      fMaxBlk[m] = fMaxBlk[m-1];
+    fMaxBlk[m] = k;
+  }
+
+  for( Int_t i = 0; i < (Int_t)fMaxBlk.size(); i++ ) {
+    Int_t k = fMaxBlk[i];
+    double  e = fBlkE[k];                   // Sums of ei, xi*ei and yi*ei
+    double  sxe = e * fBlockX[k];
+    double  sye = e * fBlockY[k];
+    Int_t mult = 1;
+    fBlkClust[k] = i;
+    for( Int_t j = fNbStart[k]; j < fNbStart[k+1]; j++ ) {
+      Int_t n = fNbList[j];
+      double en = fBlkE[n];
+      if( en > 0 && fBlkClust[n] < 0 ) {
+	fBlkClust[n] = i;
+	sxe += en * fBlockX[n];
+	sye += en * fBlockY[n];
+	e   += en;
+	mult++;
+      }
+    }
+    fClE[i]    = e;
+    fClX[i]    = sxe/e;
+    fClY[i]    = sye/e;
+    fClMult[i] = mult;
+  }
+  fNclust = fMaxBlk.size();
+
+  // Main cluster: its blocks, center first
+  if( fNclust > 0 ) {
+    Int_t k = fMaxBlk[0];
+    Int_t mult = 0;
+    fNblk[mult]   = k;
+    fEblk[mult++] = fBlkE[k];
+    for( Int_t j = fNbStart[k]; j < fNbStart[k+1]; j++ ) {
+      Int_t n = fNbList[j];
+      if( fBlkClust[n] == 0 && mult < fNclublk ) {
+	fNblk[mult]   = n;
+	fEblk[mult++] = fBlkE[n];
+      }
+    }
+    fE    = fClE[0];
+    fX    = fClX[0];
+    fY    = fClY[0];
+    fMult = fClMult[0];
+  }
+
+  // Reset the workspace for the next event. Only hit blocks were touched.
+  for( Int_t i = 0; i < nhit; i++ ) {
+    Int_t k = fHitBlk[i];
+    fBlkE[k] = 0;
+    fBlkClust[k] = -1;
+  }
+}
+
 //_____________________________________________________________________________
 Int_t TriFadcShower::CoarseProcess( TClonesArray& tracks )
 {
@@ -527,6 +678,9 @@ Int_t TriFadcShower::CoarseProcess( TClonesArray& tracks )
   // into the following local data structure:
   //
   // fNclust        -  Number of clusters in shower;
+  // fClE[], fClX[], fClY[], fClMult[]
+  //                -  Energy, X, Y and number of blocks of each cluster,
+  //                   by decreasing energy of the center block;
   // fE             -  Energy (in MeV) of the "main" cluster;
   // fX             -  X-coordinate (in cm) of the cluster;
   // fY             -  Y-coordinate (in cm) of the cluster;
@@ -534,53 +688,10 @@ Int_t TriFadcShower::CoarseProcess( TClonesArray& tracks )
   // fNblk[0]...[5] -  Numbers of blocks composing the cluster;
   // fEblk[0]...[5] -  Energies in blocks composing the cluster;
   //
-  // Only one ("main") cluster, i.e. the cluster with the largest energy
-  // deposition is considered. Units are MeV for energies and cm for
-  // coordinates.
+  // The "main" cluster is the first one, i.e. the one around the block
+  // with the largest energy deposition. Units are MeV for energies and cm for coordinates.
 
-  fNclust = 0;
-  int nmax = -1;
-  double  emax = fEmin;                     // Min threshold of energy in center
-  for ( int  i = 0; i < fNelem; i++) {      // Find the block with max energy:
-    double  ei = fA_c[i];                   // Energy in next block
-    if ( ei > emax) {
-      nmax = i;                             // Number of block with max energy
-      emax = ei;                            // Max energy per a blocks
-    }
-  }
-  if ( nmax >= 0 ) {
-    short mult = 0, nr, nc, ir, ic, dr, dc;
-    double  sxe = 0, sye = 0;               // Sums of xi*ei and yi*ei
-    nc = nmax/fNrows;                       // Column of the block with max engy
-    nr = nmax%fNrows;                       // Row of the block with max energy
-                                            // Add the block to cluster (center)
-    fNblk[mult]   = nmax;                   // Add number of the block (center)
-    fEblk[mult++] = emax;                   // Add energy in the block (center)
-    sxe = emax * fBlockX[nmax];             // Sum of xi*ei
-    sye = emax * fBlockY[nmax];             // Sum of yi*ei
-    for ( int  i = 0; i < fNelem; i++) {    // Detach surround blocks:
-      double  ei = fA_c[i];                 // Energy in next block
-      if ( ei>0 && i!=nmax ) {              // Some energy out of cluster center
-	ic = i/fNrows;                      // Column of next block
-	ir = i%fNrows;                      // Row of next block
-	dr = nr - ir;                       // Distance on row up to center
-	dc = nc - ic;                       // Distance on column up to center
-	if ( -2<dr&&dr<2&&-2<dc&&dc<2 ) {   // Surround block:
-	                                    // Add block to cluster (surround)
-	  fNblk[mult]   = i;                // Add number of block (surround)
-	  fEblk[mult++] = ei;               // Add energy of block (surround)
-	  sxe  += ei * fBlockX[i];          // Sum of xi*ei of cluster blocks
-	  sye  += ei * fBlockY[i];          // Sum of yi*ei of cluster blocks
-	  emax += ei;                       // Sum of energies in cluster blocks
-	}
-      }
-    }
-    fNclust = 1;                            // One ("main") cluster detected
-    fE      = emax;                         // Energy (MeV) in "main" cluster
-    fX      = sxe/emax;                     // X coordinate (cm) of the cluster
-    fY      = sye/emax;                     // Y coordinate (cm) of the cluster
-    fMult   = mult;                         // Number of blocks in "main" clust.
-  }
+  FindClusters();
 
   // Calculate track projections onto shower plane
  
@@ -9,6 +9,7 @@
 
 #include "THaPidDetector.h"
 #include "Fadc250Module.h"
+#include "TriFadcPulse.h"
 
 //----------------//
 //   C++ StdLib   //
@@ -35,6 +36,10 @@ public:
           Float_t    GetE() const      { return fE; }
           Float_t    GetX() const      { return fX; }
           Float_t    GetY() const      { return fY; }
+          Float_t    GetClusterE( Int_t i ) const    { return fClE[i]; }
+          Float_t    GetClusterX( Int_t i ) const    { return fClX[i]; }
+          Float_t    GetClusterY( Int_t i ) const    { return fClY[i]; }
+          Int_t      GetClusterMult( Int_t i ) const { return fClMult[i]; }
 
 protected:
 
@@ -49,6 +54,8 @@ protected:
   // Geometry
   Float_t*   fBlockX;    // [fNelem] x positions (cm) of block centers
   Float_t*   fBlockY;    // [fNelem] y positions (cm) of block centers
+  std::vector<Int_t> fNbStart; // Neighbours of block k are
+  std::vector<Int_t> fNbList;  // fNbList[fNbStart[k]..fNbStart[k+1]-1]
 
   // Calibration
   Float_t*   fPed;       // [fNelem] Pedestals for each block
@@ -71,6 +78,16 @@ protected:
   Int_t      fMult;      // Number of blocks in main cluster
   Int_t*     fNblk;      // [fNclublk] Numbers of blocks composing main cluster
   Float_t*   fEblk;      // [fNclublk] Energies of blocks composing main cluster
+  Float_t*   fClE;       // [fNclust] Energy (MeV) of each cluster
+  Float_t*   fClX;       // [fNclust] x position (cm) of each cluster
+  Float_t*   fClY;       // [fNclust] y position (cm) of each cluster
+  Int_t*     fClMult;    // [fNclust] Number of blocks in each cluster
+
+  // Cluster finder workspace
+  std::vector<Int_t>   fHitBlk;   // Blocks decoded in this event
+  std::vector<Float_t> fBlkE;     // [fNelem] Energy of hit blocks, 0 otherwise
+  std::vector<Int_t>   fBlkClust; // [fNelem] Cluster of each block, -1 if none
+  std::vector<Int_t>   fMaxBlk;   // Cluster centers, by decreasing energy
 
 
   //=========FADC==============
@@ -83,6 +100,8 @@ protected:
   Int_t    fNSB;         //number of integrated samples before threshold crossing
   Int_t    fWin;         //total number of samples in FADC window
   Int_t    fTFlag;       //flag for FADC threshold on vs FADC threshold off
+  Int_t    fTET;         //FADC threshold (raw sample value), for raw-sample modes
+  TriFadcPulse fPulse;   //! pulse analysis of raw samples
 
   Float_t*   fPeak;         // [fNelem] Array of FADC ADC peak values
   Float_t*   fT;       // [fNelem] Array of FADC TDC times of channels
@@ -92,6 +111,8 @@ protected:
   UInt_t      fNEventsWithWarnings; // Events with warnings
   
   void           DeleteArrays();
+  void           BuildNeighbours( Int_t ncols );
+  void           FindClusters();
   virtual Int_t  ReadDatabase( const TDatime& date );
   virtual Int_t  DefineVariables( EMode mode = kDefine );
 
@@ -9,6 +9,7 @@
 #pragma link C++ class TriSpectrometerDetector+;
 #pragma link C++ class TriTrackingDetector+;
 #pragma link C++ class TriVDC+;
+#pragma link C++ class TriVDCOptics+;
 #pragma link C++ class TriVDCPlane+;
 #pragma link C++ class TriVDCUVPlane+;
 #pragma link C++ class TriVDCPlane+;
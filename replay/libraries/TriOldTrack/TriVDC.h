@@ -8,7 +8,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "TriTrackingDetector.h"
+#include "TriVDCOptics.h"
 #include <vector>
+#include <utility>
 
 class TriVDCUVPlane;
 class TriTrack;
@@ -36,6 +38,7 @@ public:
 
   virtual Double_t GetVDCAngle() { return fVDCAngle; }
   virtual Double_t GetSpacing()  { return fUSpacing;  }
+  Int_t GetClusterFitMode() const { return fClusterFitMode; }
 
   virtual void Print(const Option_t* opt) const;
 
@@ -68,6 +71,21 @@ protected:
 
   TClonesArray*  fUVpairs;  // Pairs of matched UV tracks (TriVDCTrackPair obj)
 
+  // candidate lower/upper UV track pair, for ConstructTracks
+  struct UVPairCand {
+    Double_t error;          // goodness of match (TriVDCTrackPair::Analyze)
+    Int_t    lower, upper;   // UV track numbers in fLower, fUpper
+    // heap order: best match on top, ties by track numbers
+    static bool Worse( const UVPairCand& a, const UVPairCand& b ) {
+      if( a.error != b.error ) return a.error > b.error;
+      if( a.lower != b.lower ) return a.lower > b.lower;
+      return a.upper > b.upper;
+    }
+  };
+  std::vector<UVPairCand> fPairCand; // Pair candidates, reused every event
+  std::vector<Double_t>   fUVPos;    // x,y,theta,phi of lower+upper UV tracks
+  std::vector<std::pair<Double_t,Int_t> > fUpperX; // x and number of upper UV tracks
+
   Double_t fVDCAngle;       // Angle from the VDC cs to TRANSPORT cs (rad)
   Double_t fSin_vdc;        // Sine of VDC angle
   Double_t fCos_vdc;        // Cosine of VDC angle
@@ -77,7 +95,9 @@ protected:
   Int_t    fNtracks;        // Number of tracks found in ConstructTracks
 
   Int_t    fNumIter;        // Number of iterations for FineTrack()
-  Double_t fErrorCutoff;    // Cut on track matching error
+  Double_t fMaxPairDist;    // Max x distance of projected lower to upper track (m)
+  Double_t fErrorCutoff;    // Cut on track matching error (m^2)
+  Int_t    fClusterFitMode; // Cluster fit mode (TriVDCCluster::EMode)
 
   Double_t fCentralDist;    // the path length of the central ray from
                             // the origin of the transport coordinates to 
@@ -117,6 +137,8 @@ protected:
 
   std::vector<THaMatrixElement> fLMatrixElems;   // Path-length corrections (meters)
 
+  TriVDCOptics fOptics;     // all target matrix elements, flattened
+
   void CalcFocalPlaneCoords( TriTrack* track, const ECoordTypes mode);
   void CalcTargetCoords(TriTrack *the_track, const ECoordTypes mode);
   void CalcMatrix(const double x, std::vector<THaMatrixElement> &matrix);
@@ -124,11 +146,12 @@ protected:
   Double_t PolyInv(const double x1, const double x2, const double xacc, 
 		 const double y, const int norder, 
 		 const std::vector<double> &a);
-  Double_t CalcTargetVar(const std::vector<THaMatrixElement> &matrix, 
-			 const double powers[][5]);
-  Double_t CalcTarget2FPLen(const std::vector<THaMatrixElement>& matrix,
-			    const Double_t powers[][5]);
+  void BuildOptics();
+  void SetTargetCoords(TriTrack *the_track, Int_t i);
   Int_t ReadDatabase( const TDatime& date );
+  Bool_t FindSection( FILE* file, const char* name );
+  Int_t ReadPairing( FILE* file );
+  Int_t ReadClusterFitMode( FILE* file );
 
   virtual Int_t ConstructTracks( TClonesArray* tracks = NULL, Int_t flag = 0 );
 
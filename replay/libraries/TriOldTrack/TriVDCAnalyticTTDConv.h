@@ -20,6 +20,9 @@ public:
 
   virtual Double_t ConvertTimeToDist(Double_t time, Double_t tanTheta,
 				     Double_t *ddist=0);
+  virtual void     ConvertTimeToDist(Int_t n, const Double_t* time,
+				     Double_t tanTheta, Double_t* dist,
+				     Double_t* ddist=0);
 
 
   // Get and Set Functions 
@@ -39,6 +42,8 @@ protected:
 
   Double_t fdtime;      // uncertainty in the measured time
 
+  void CalcCorrections(Double_t tanTheta, Double_t& a1, Double_t& a2) const;
+
   ClassDef(TriVDCAnalyticTTDConv,0)             // VDC Analytic TTD Conv class
 };
 
@@ -18,7 +18,8 @@ class TriVDCCluster : public TObject {
 
 public:
   TriVDCCluster( TriVDCPlane* owner = NULL ) :
-    fSize(0), fPlane(owner), fSlope(kBig), fSigmaSlope(kBig), fInt(kBig),
+    fSize(0), fNMultiHits(0), fPlane(owner), fSlope(kBig), fSigmaSlope(kBig),
+    fInt(kBig),
     fSigmaInt(kBig), fT0(0.0), fSigmaT0(kBig), fPivot(NULL),
     fTimeCorrection(0.0),
     fFitOK(false), fLocalSlope(kBig), fChi2(kBig), fNDoF(0.0)  {}
@@ -29,6 +30,7 @@ public:
   enum EMode { kSimple, kT0, kFull };
 
   virtual void   AddHit(TriVDCHit * hit);
+  virtual void   AddMultiHit(TriVDCHit * hit); // later hit on last wire
   virtual void   EstTrackParameters();
   virtual void   ConvertTimeToDist();
   virtual void   FitTrack( EMode mode = kSimple );
@@ -47,6 +49,9 @@ public:
   TriVDCHit *    GetHit(Int_t i)     const { return fHits[i]; }
   TriVDCPlane*   GetPlane()          const { return fPlane; }
   Int_t          GetSize ()          const { return fSize; }
+  Int_t          GetNMultiHits()     const { return fNMultiHits; }
+  Double_t       GetT0()             const { return fT0; }
+  Double_t       GetSigmaT0()        const { return fSigmaT0; }
   Double_t       GetSlope()          const { return fSlope; }
   Double_t       GetLocalSlope()     const { return fLocalSlope; }
   Double_t       GetSigmaSlope()     const { return fSigmaSlope; }
@@ -72,6 +77,9 @@ protected:
 
   Int_t          fSize;              // Size of cluster (no. of hits)
   TriVDCHit*     fHits[MAX_SIZE];    // [fSize] Hits associated w/this cluster
+  Int_t          fNMultiHits;        // Number of additional hits on wires
+  TriVDCHit*     fMultiHits[MAX_SIZE]; //! Additional (later) hits on wires
+  Int_t          fMultiHitIdx[MAX_SIZE]; //! fHits index of their wire
   TriVDCPlane*   fPlane;             // Plane the cluster belongs to
   //  TriVDCUVTrack * fUVTrack;      // UV Track the cluster belongs to
   //  THaTrack * fTrack;             // Track the cluster belongs to
@@ -91,6 +99,8 @@ protected:
   virtual void   CalcDist();         // calculate the track to wire distances
   virtual void   FitSimpleTrack();
   virtual void   FitSimpleTrackWgt(); // present for testing
+  virtual void   FitT0Track();        // slope, intercept and t0
+  virtual void   FitMultiHitTrack();  // FitT0Track, choosing among multihits
 
   ClassDef(TriVDCCluster,0)          // A group of VDC hits
 };
@@ -0,0 +1,59 @@
+#ifndef ROOT_TriVDCOptics
+#define ROOT_TriVDCOptics
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// TriVDCOptics                                                              //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+
+class TriVDCOptics {
+
+public:
+  // Target quantities computed from the focal-plane coordinates
+  enum EVar { kDelta = 0, kTheta, kY, kPhi, kPathLen, kNVar };
+  enum { kPORDER = 7 };   // max. number of x_fp polynomial coefficients
+
+  TriVDCOptics() : fMaxPow(0), fN(0) {}
+  virtual ~TriVDCOptics() {}
+
+  void     Clear();
+  void     AddTerm( EVar var, const std::vector<double>& poly, Int_t order,
+		    Int_t ex, Int_t eth, Int_t ey, Int_t eph, Int_t eath );
+  Int_t    GetNTerms() const { return fVar.size(); }
+
+  // Batch evaluation: SetN, SetTrack for each track, Eval, GetResult
+  void     SetN( Int_t n );
+  Int_t    GetN() const { return fN; }
+  void     SetTrack( Int_t i, Double_t x, Double_t th, Double_t y,
+		     Double_t ph ) {
+    fX[i] = x; fTh[i] = th; fY[i] = y; fPh[i] = ph;
+  }
+  void     Eval();
+  Double_t GetResult( EVar var, Int_t i ) const { return fOut[var*fN+i]; }
+
+protected:
+
+  // Terms of all target variables, structure of arrays.  Each term is
+  //   P(x_fp) * x_fp^ex * th_fp^eth * y_fp^ey * ph_fp^eph * |th_fp|^eath
+  // with P a polynomial of order fOrder and coefficients fPoly.
+  std::vector<Int_t>    fVar;    // target variable (EVar) of each term
+  std::vector<Int_t>    fOrder;  // number of polynomial coefficients
+  std::vector<Double_t> fPoly;   // kPORDER coefficients per term
+  std::vector<Int_t>    fEx, fEth, fEy, fEph, fEath;  // exponents
+  Int_t                 fMaxPow; // largest exponent of any term
+
+  // Batch of tracks, one array per coordinate
+  Int_t                 fN;      // number of tracks in the batch
+  std::vector<Double_t> fX, fTh, fY, fPh;
+  std::vector<Double_t> fPow;    // powers of x,th,y,ph,|th|, each [pow][track]
+  std::vector<Double_t> fVal;    // scratch, one term for all tracks
+  std::vector<Double_t> fOut;    // results, [var][track]
+
+  ClassDef(TriVDCOptics,0)   // Focal plane to target optics evaluator
+};
+
+#endif
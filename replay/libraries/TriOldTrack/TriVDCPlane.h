@@ -10,6 +10,7 @@
 #include "THaSubDetector.h"
 #include "TClonesArray.h"
 #include <cassert>
+#include <vector>
 
 class THaEvData;
 class TriVDCWire;
@@ -51,6 +52,11 @@ public:
   { assert( i>=0 && i<GetNHits() );
     return (TriVDCHit*)fHits->UncheckedAt(i); }
 
+  // Hits of the current event in columns, in the same order as fHits
+  Int_t    GetHitWireNum(Int_t i) const { return fHitWire[i]; }
+  Int_t    GetHitRawTime(Int_t i) const { return fHitRaw[i]; }
+  Double_t GetHitTime(Int_t i)    const { return fHitTime[i]; }
+
   Int_t    GetNWiresHit() const  { return fNWiresHit; } 
 
   Double_t GetZ()        const   { return fZ; }
@@ -73,11 +79,23 @@ protected:
   
   Int_t fNWiresHit;  // Number of wires that were hit
 
+  // Columnar hit store, sorted by wire number and, for each wire, by time
+  std::vector<Int_t>    fHitWire;   //! Wire numbers
+  std::vector<Int_t>    fHitRaw;    //! Raw TDC values
+  std::vector<Double_t> fHitTime;   //! Drift times (s)
+
+  // Decode() scratch: hits in readout order, hits per wire
+  std::vector<Int_t>    fDecWire;   //!
+  std::vector<Int_t>    fDecRaw;    //!
+  std::vector<Double_t> fDecTime;   //!
+  std::vector<Int_t>    fWireStart; //!
+
   // The following parameters are read from database.
  
   Int_t fNMaxGap;            // Max gap in a cluster
   Int_t fMinTime, fMaxTime;  // Min and Max limits of TDC times for clusters
   Int_t fFlags;              // Analysis control flags
+  Int_t fFitMode;            // Cluster fit mode (TriVDCCluster::EMode)
 
   Double_t fZ;            // Z coordinate of planes in U1 coord sys (m)
   Double_t fWBeg;         // Position of 1-st wire in E-arm coord sys (m)
@@ -102,6 +120,8 @@ protected:
   virtual Int_t ReadDatabase( const TDatime& date );
   virtual Int_t DefineVariables( EMode mode = kDefine );
 
+  void          SortHits();
+
   ClassDef(TriVDCPlane,0)             // VDCPlane class
 };
 
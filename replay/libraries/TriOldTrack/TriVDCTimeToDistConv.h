@@ -19,6 +19,11 @@ public:
 
   virtual Double_t ConvertTimeToDist(Double_t time, Double_t tanTheta,
 				     Double_t *ddist=0) = 0;
+  // Convert the drift times of 'n' hits seen by one track at slope
+  // 'tanTheta', e.g. those of a cluster
+  virtual void     ConvertTimeToDist(Int_t n, const Double_t* time,
+				     Double_t tanTheta, Double_t* dist,
+				     Double_t* ddist=0);
 private:
 
   TriVDCTimeToDistConv( const TriVDCTimeToDistConv& );
@@ -46,6 +46,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include "THaVarList.h"
 #include "VarDef.h"
 #include "THaString.h"
@@ -134,57 +135,35 @@ Int_t TriScalerEvtHandler::Analyze(THaEvData *evdata)
 
   if (fDebugFile) *fDebugFile<<"\n\nTriScalerEvtHandler :: Debugging event type "<<dec<<evdata->GetEvType()<<endl<<endl;
 
-  // local copy of data
+  // Local copy of the data. The scaler headers are indexed in the same
+  // pass: at each header the scaler is decoded from there, and its data
+  // words are skipped, so they cannot be mistaken for headers.
 
   for (Int_t i=0; i<ndata; i++) rdata[i] = evdata->GetRawData(i);
 
-  Int_t nskip=0;
-  UInt_t *p = rdata;
-  UInt_t *pstop = rdata+ndata;
-  int j=0;
-
   Int_t ifound = 0;
-
-  while (p < pstop && j < ndata) {
-    if (fDebugFile) {
-      *fDebugFile << "p  and  pstop  "<<j++<<"   "<<p<<"   "<<pstop<<"   "<<hex<<*p<<"   "<<dec<<endl;
+  for (size_t j=0; j<fOffset.size(); j++) fOffset[j] = -1;
+
+  Int_t i = 0;
+  while (i < ndata && ifound < static_cast<Int_t>(scalers.size())) {
+    Int_t j = FindHeader(rdata[i]);
+    if (j < 0) {
+      i++;
+      continue;
     }
-    nskip = 1;
-    Int_t itimeout=0;
-    for (UInt_t j=0; j<scalers.size(); j++) {
-    // bump pointer until scaler found, and don't decode if already found for this event.
-      if (scalerloc[j]->found) continue;
-      if (fDebugFile) *fDebugFile << "Slot "<<j<<"   "<<scalers[j]->GetSlot()<<endl;
-      while (p < pstop) {
-        if (scalers[j]->IsSlot(*p) == kTRUE) {
-            scalerloc[j]->found=kTRUE;
-            ifound = 1;
-            goto found1;
-	}
-        p++;
-        if (itimeout++ > 5000) { // avoid infinite loop
-	  cout << "TriScalerEvtHandler:: cannot find a slot "<<endl;
-          goto giveup1;
-	}
-      }
-found1:
-      if(p==pstop && ifound==0)break;
-      nskip = scalers[j]->Decode(p);
-      if (fDebugFile && nskip > 1) {
-	*fDebugFile << "\n===== Scaler # "<<j<<"     fName = "<<fName<<"   nskip = "<<nskip<<endl;
-	scalers[j]->DebugPrint(fDebugFile);
-      }
-      if (nskip > 1) goto continue1;
+    fOffset[j] = i;
+    ifound++;
+    Int_t nskip = scalers[j]->Decode(rdata+i);
+    if (fDebugFile) {
+      *fDebugFile << "\n===== Scaler # "<<j<<"     fName = "<<fName<<"   offset = "<<i<<"   nskip = "<<nskip<<endl;
+      scalers[j]->DebugPrint(fDebugFile);
     }
-continue1:
-    p = p + nskip;
+    i += (nskip > 1) ? nskip : 1;
   }
 
-giveup1:
-
   if (fDebugFile) {
     *fDebugFile << "Finished with decoding.  "<<endl;
-    *fDebugFile << "   Found flag   =  "<<ifound<<endl;
+    *fDebugFile << "   Scalers found =  "<<ifound<<endl;
   }
 
   // L-HRS has headers which are different from R-HRS, but both are
@@ -212,10 +191,7 @@ giveup1:
 
   evcount = evcount + 1.0;
 
-  for (size_t j=0; j<scalers.size(); j++) {
-     scalers[j]->Clear("");
-     scalerloc[j]->found=kFALSE;
-  }
+  for (size_t j=0; j<scalers.size(); j++) scalers[j]->Clear("");
 
   if (fDebugFile) *fDebugFile << "scaler tree ptr  "<<fScalerTree<<endl;
 
@@ -313,7 +289,7 @@ THaAnalysisObject::EStatus TriScalerEvtHandler::Init(const TDatime& date)
 	}
 	if (scalers.size() > 0) {
 	  UInt_t idx = scalers.size()-1;
-	  scalers[idx]->SetHeader(header, mask);
+	  SetScalerHeader(idx, header, mask);
 // The normalization slot has the clock in it, so we automatically recognize it.
 // fNormIdx is the index in scaler[] and 
 // fNormSlot is the slot#, checked for consistency
@@ -361,10 +337,10 @@ THaAnalysisObject::EStatus TriScalerEvtHandler::Init(const TDatime& date)
     scalers.push_back(new Scaler3800(1,1));
     scalers.push_back(new Scaler3800(1,2));
     scalers.push_back(new Scaler3800(1,3));
-    scalers[0]->SetHeader(0xabc00000, 0xffff0000);
-    scalers[1]->SetHeader(0xabc10000, 0xffff0000);
-    scalers[2]->SetHeader(0xabc20000, 0xffff0000);
-    scalers[3]->SetHeader(0xabc30000, 0xffff0000);
+    SetScalerHeader(0, 0xabc00000, 0xffff0000);
+    SetScalerHeader(1, 0xabc10000, 0xffff0000);
+    SetScalerHeader(2, 0xabc20000, 0xffff0000);
+    SetScalerHeader(3, 0xabc30000, 0xffff0000);
     scalers[0]->LoadNormScaler(scalers[1]);
     scalers[1]->SetClock(4, 7, 1024);
     scalers[2]->LoadNormScaler(scalers[1]);
@@ -374,10 +350,10 @@ THaAnalysisObject::EStatus TriScalerEvtHandler::Init(const TDatime& date)
     scalers.push_back(new Scaler3800(2,0));
     scalers.push_back(new Scaler1151(2,1));
     scalers.push_back(new Scaler1151(2,2));
-    scalers[0]->SetHeader(0xceb00000, 0xffff0000);
-    scalers[1]->SetHeader(0xceb10000, 0xffff0000);
-    scalers[2]->SetHeader(0xceb20000, 0xffff0000);
-    scalers[3]->SetHeader(0xceb30000, 0xffff0000);
+    SetScalerHeader(0, 0xceb00000, 0xffff0000);
+    SetScalerHeader(1, 0xceb10000, 0xffff0000);
+    SetScalerHeader(2, 0xceb20000, 0xffff0000);
+    SetScalerHeader(3, 0xceb30000, 0xffff0000);
     scalers[0]->SetClock(4, 7, 1024);
     scalers[1]->LoadNormScaler(scalers[0]);
     scalers[2]->LoadNormScaler(scalers[0]);
@@ -410,15 +386,69 @@ THaAnalysisObject::EStatus TriScalerEvtHandler::Init(const TDatime& date)
       scalers[i]->DebugPrint(fDebugFile);
     }
   }
-  for (size_t j=0; j<scalers.size(); j++) {
-     scalers[j]->Clear("");
-     scalerloc[j]->found=kFALSE;
-  }
+  for (size_t j=0; j<scalers.size(); j++) scalers[j]->Clear("");
 
+  BuildHeaderIndex();
 
   return kOK;
 }
 
+void TriScalerEvtHandler::SetScalerHeader(UInt_t idx, UInt_t header, UInt_t mask)
+{
+  // Set the header of scalers[idx] and remember it for the header index
+  scalers[idx]->SetHeader(header, mask);
+  if (fHeader.size() < scalers.size()) {
+    fHeader.resize(scalers.size(), 0);
+    fHeaderMask.resize(scalers.size(), 0);
+  }
+  fHeader[idx] = header;
+  fHeaderMask[idx] = mask;
+}
+
+void TriScalerEvtHandler::BuildHeaderIndex()
+{
+  // Sort the scaler headers by mask and header word (see FindHeader)
+  fMaskList.clear();
+  fMaskStart.clear();
+  fIdxHeader.clear();
+  fIdxScaler.clear();
+  fOffset.assign(scalers.size(), -1);
+  fHeader.resize(scalers.size(), 0);
+  fHeaderMask.resize(scalers.size(), 0);
+
+  vector< pair< pair<UInt_t,UInt_t>, Int_t > > hdr;
+  for (UInt_t j=0; j<scalers.size(); j++)
+    hdr.push_back(make_pair(make_pair(fHeaderMask[j], fHeader[j]&fHeaderMask[j]), j));
+  sort(hdr.begin(), hdr.end());
+  for (UInt_t k=0; k<hdr.size(); k++) {
+    if (k == 0 || hdr[k].first.first != hdr[k-1].first.first) {
+      fMaskList.push_back(hdr[k].first.first);
+      fMaskStart.push_back(k);
+    }
+    fIdxHeader.push_back(hdr[k].first.second);
+    fIdxScaler.push_back(hdr[k].second);
+  }
+  fMaskStart.push_back(hdr.size());
+}
+
+Int_t TriScalerEvtHandler::FindHeader(UInt_t word) const
+{
+  // Index in scalers[] of the scaler whose header is 'word', -1 if none.
+  // Of scalers with the same header, the first one not yet found in this
+  // event is taken.
+  for (UInt_t m=0; m<fMaskList.size(); m++) {
+    UInt_t key = word & fMaskList[m];
+    vector<UInt_t>::const_iterator first = fIdxHeader.begin()+fMaskStart[m];
+    vector<UInt_t>::const_iterator last  = fIdxHeader.begin()+fMaskStart[m+1];
+    for (vector<UInt_t>::const_iterator it = lower_bound(first, last, key);
+	 it != last && *it == key; ++it) {
+      Int_t j = fIdxScaler[it - fIdxHeader.begin()];
+      if (fOffset[j] < 0) return j;
+    }
+  }
+  return -1;
+}
+
 void TriScalerEvtHandler::AddVars(TString name, TString desc, Int_t islot,
 				  Int_t ichan, Int_t ikind)
 {
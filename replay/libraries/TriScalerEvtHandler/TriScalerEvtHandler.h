@@ -42,6 +42,9 @@ private:
 
    void AddVars(TString name, TString desc, Int_t iscal, Int_t ichan, Int_t ikind);
    void DefVars();
+   void SetScalerHeader(UInt_t idx, UInt_t header, UInt_t mask);
+   void BuildHeaderIndex();
+   Int_t FindHeader(UInt_t word) const;
 
    std::vector<Decoder::GenScaler*> scalers;
    std::vector<ScalerVar*> scalerloc;
@@ -51,6 +54,16 @@ private:
    Double_t *dvars;
    TTree *fScalerTree;
 
+   // Header index: the headers of all scalers, grouped by mask and sorted
+   // within each group, so that the scaler starting at a given word can be
+   // looked up without trying every scaler.
+   std::vector<UInt_t> fHeader, fHeaderMask;  // per scaler, as configured
+   std::vector<UInt_t> fMaskList;     // distinct header masks
+   std::vector<UInt_t> fMaskStart;    // group of mask i: [fMaskStart[i],fMaskStart[i+1])
+   std::vector<UInt_t> fIdxHeader;    // header words
+   std::vector<Int_t>  fIdxScaler;    // index in scalers[] of each header
+   std::vector<Int_t>  fOffset;       // per scaler, offset of its header in this event, -1 if none
+
    TriScalerEvtHandler(const TriScalerEvtHandler& fh);
    TriScalerEvtHandler& operator=(const TriScalerEvtHandler& fh);
 
@@ -11,6 +11,7 @@
 #include <vector>
 
 class THaVar;
+class THaCut;
 class TH1F;
 
 class TriVDCeff : public THaPhysicsModule {
@@ -25,24 +26,40 @@ public:
 
   void            Reset( Option_t* opt="" );
 
+  // Efficiency histograms, brought up to date on request
+  void            UpdateHist();
+  TH1F*           GetEffHist( UInt_t ivar, UInt_t icls=0 );
+  TH1F*           GetIneffHist( UInt_t ivar, UInt_t icls=0 );
+
 protected:
 
   typedef std::vector<Long64_t> Vcnt_t;
   typedef const THaVar CVar_t;
 
+  // Class of events for which efficiencies are accumulated separately.
+  // Class 0 is all events; the others are those passing a cut.
+  struct CutClass_t {
+    TString       cutname;
+    TString       suffix;    // appended to the histogram names
+    const THaCut* cut;
+    CutClass_t( const char* cn, const char* sf )
+      : cutname(cn), suffix(sf), cut(0) {}
+  };
+
   // Data needed for efficiency calculation for one VDC plane/wire spectrum
   struct VDCvar_t {
     TString  name;
     TString  histname;
     CVar_t*  pvar;
     Int_t    nwire;
-    Vcnt_t   ncnt;
+    Vcnt_t   ncnt;           // per cut class and wire, [icls*nwire+wire]
     Vcnt_t   nhit;
     TH1F*    hist_nhit;
-    TH1F*    hist_eff;
-    TH1F*    hist_ineff;
+    std::vector<TH1F*> hist_eff;   // per cut class
+    std::vector<TH1F*> hist_ineff;
+    std::vector<TString> hist_sfx; // name suffix of the per-class histograms
     VDCvar_t( const char* nm, const char* hn, Int_t nw )
-      : name(nm), histname(hn), pvar(0), nwire(nw), hist_nhit(0), hist_eff(0), hist_ineff(0){}
+      : name(nm), histname(hn), pvar(0), nwire(nw), hist_nhit(0) {}
     ~VDCvar_t();
     void     Reset( Option_t* opt ="" );
   };
@@ -52,10 +69,13 @@ protected:
 
   // Internal working storage
   std::vector<VDCvar_t>  fVDCvar;
+  std::vector<CutClass_t> fCutClass;
   std::vector<Short_t>   fWire;
   std::vector<bool>      fHitWire;
+  std::vector<Int_t>     fActive;   // cut classes of the current event
 
   Long64_t  fNevt;
+  Bool_t    fHistStale;  // counters changed since last UpdateHist
 
   // Configuration parameters
   Int_t     fCycle;
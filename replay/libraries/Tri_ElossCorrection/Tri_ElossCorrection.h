@@ -9,9 +9,39 @@
 
 #include "THaPhysicsModule.h"
 #include "TString.h"
+#include <vector>
 
 class THaVertexModule;
 
+// Energy loss of one type in one medium, tabulated per unit pathlength
+// on a grid in ln(beta*gamma). Tables are built once per process and
+// shared by all modules, see Get().
+class Tri_ElossTable {
+
+public:
+  enum EType { kElectron, kHadron, kMostProb };
+
+  static const Tri_ElossTable* Get( EType type, Double_t z_med,
+				    Double_t a_med, Double_t d_med );
+  static Double_t Exact( EType type, Int_t Z_part, Double_t beta,
+			 Double_t z_med, Double_t a_med, Double_t d_med,
+			 Double_t pathlength /* m */ );
+
+  Double_t Eval( Int_t Z_part, Double_t beta,
+		 Double_t pathlength /* m */ ) const;   // GeV
+
+  ~Tri_ElossTable() {}
+
+private:
+  Tri_ElossTable( EType type, Double_t z_med, Double_t a_med, Double_t d_med );
+
+  EType    fType;
+  Double_t fZmed, fAmed, fDmed;  // Medium
+  Double_t fC;                   // kMostProb: 0.15355*z_med/a_med
+  Bool_t   fValid;               // Medium known to the library functions
+  std::vector<Double_t> fVal;    // Table values at the grid points
+};
+
 class Tri_ElossCorrection : public THaPhysicsModule {
   
 public:
@@ -32,6 +62,8 @@ public:
           void      SetPathlength( Double_t pathlength /* m */ );
           void      SetPathlength( const char* vertex_module,
 				   Double_t z_ref /* m */, Double_t scale = 1.0 );
+          void      SetTableMode( Bool_t enable=kTRUE,
+				  Double_t check=0.0 /* max rel. deviation */ );
 
   static  Double_t  ElossElectron( Double_t beta, Double_t z_med,
 				   Double_t a_med, 
@@ -68,6 +100,16 @@ protected:
   TString            fInputName;   // Name of input module
   TString            fVertexName;  // Name of vertex module for var pathlength, if any
   THaVertexModule*   fVertexModule;// Pointer to vertex module
+  Int_t              fTableMode;   // Use eloss tables (1) or exact formulas (0)
+  Bool_t             fTableModeSet;// Table mode set by SetTableMode()
+  Double_t           fTableCheck;  // If > 0, check tables against exact formulas
+  Int_t              fNTableWarn;  // Number of failed table checks
+
+  // Energy loss of this module's particle in the given medium
+  Double_t ElossInMedium( Tri_ElossTable::EType type, Double_t beta,
+			  Double_t z_med, Double_t a_med,
+			  Double_t d_med /* g/cm^3 */,
+			  Double_t pathlength /* m */ );
 
   // Setup functions
   virtual Int_t DefineVariables( EMode mode = kDefine );
@@ -2,6 +2,7 @@
 currentdir=`pwd`
 
 for dir in */; do  echo "$dir";
+[ -f $currentdir/$dir/Makefile ] || continue   # header-only, e.g. TriFadcPulse
 echo " "
 echo " "
 echo "Changing to $dir, and compiling the library!"
@@ -16,6 +16,7 @@
 #include <RQ_OBJECT.h>
 #include <TQObject.h>
 #include <vector>
+#include <map>
 #include <TString.h>
 #include <TCut.h>
 #include <TTimer.h>
@@ -40,6 +41,7 @@ struct RootFileObject {
   TFile*                            RootFile;
   vector <TTree*>                   RootTree;
   vector <Int_t>                    TreeEntries;
+  map <TString,Long64_t>            HistFilled;  // tree histogram -> entries filled so far
   vector < vector <TString> >       TreeVars;
   Bool_t                            fUpdate;
   TH1D                             *mytemp1d;
@@ -63,6 +65,17 @@ struct drawcommand {
   TString objtitle;
 };
 
+struct treedrawspec {
+  // A tree draw command, resolved: which tree, what to fill, and the
+  //  name the histogram is cached under in the rootfile's directory.
+  UInt_t  iTree;
+  TString myvar;     // "x" or "y:x"
+  TString hname;
+  TString histdef;   // binning, e.g. "100,0,100"; empty for automatic
+  TString fullcut;   // cut with the defined cuts substituted
+  TString drawopt;
+};
+
 class OnlineConfig {
   RQ_OBJECT("OnlineConfig");
   // Class that takes care of the config file
@@ -156,6 +169,8 @@ public:
   UInt_t GetTreeIndex(TString,RootFileObject *r);
   UInt_t GetTreeIndexFromName(TString, RootFileObject *r);
   drawcommand fileObject2command(drawcommand,RootFileObject *r);
+  Bool_t GetTreeDrawSpec(const drawcommand&,treedrawspec&);
+  void BatchTreeDraw(const vector <drawcommand>&);
   void TreeDraw(const drawcommand&);
   void HistDraw(const drawcommand&);
   void MacroDraw(const drawcommand&);
@@ -114,6 +114,7 @@ namespace Decoder {
     void PopulateDataVector(std::vector<uint32_t>& data_vector, uint32_t data);
     Int_t SumVectorElements(const std::vector<uint32_t>& data_vector) const;
     void LoadTHaSlotDataObj(THaSlotData *sldat);
+    Int_t LoadThisBlock(THaSlotData *sldat, const EvBlock& evb);
     Int_t LoadThisBlock(THaSlotData *sldat, std::vector<UInt_t > evb);
     void PrintDataType() const;
 
@@ -45,17 +45,36 @@ public:
 
 protected:
 
+   // One "event" inside the CODA event buffer.  This is only a view:
+   // the words stay in the buffer owned by the caller of LoadSlot, which
+   // is not touched until all blocks have been loaded.  In multiblock
+   // mode the block header must be decoded in front of each event;
+   // header == 0 means there is none (a real block header has bit 31 set).
+   struct EvBlock {
+      EvBlock() : header(0), begin(0), end(0) {}
+      EvBlock(UInt_t hdr, const UInt_t* b, const UInt_t* e)
+         : header(hdr), begin(b), end(e) {}
+      UInt_t size() const { return (header ? 1 : 0) + (end - begin); }
+      UInt_t header;
+      const UInt_t* begin;
+      const UInt_t* end;
+   };
+
+   Int_t SplitBuffer(const UInt_t* pstart, const UInt_t* pstop);
    Int_t SplitBuffer(std::vector< UInt_t > bigbuffer);
    void ReStart();
+   const EvBlock& GetNextBlockRange();
    std::vector< UInt_t >GetNextBlock();
    Int_t LoadNextEvBuffer(THaSlotData *sldat)=0;
+   virtual Int_t LoadThisBlock(THaSlotData *sldat, const EvBlock& evb);
    virtual Int_t LoadThisBlock(THaSlotData *sldat, std::vector<UInt_t > evb)=0;
    Int_t fNWarnings;
    UInt_t fBlockHeader;
 
    Bool_t fFirstTime;
 
-   std::vector< std::vector<  UInt_t > > eventblock;
+   std::vector< EvBlock > eventblock;   // views into the CODA buffer
+   std::vector< UInt_t > fCopyBuffer;   // backing store for SplitBuffer(vector)
    UInt_t index_buffer;
    UInt_t GetIndex();
 
@@ -57,6 +57,9 @@ public:
        void clearEvent();                   // clear event counters
        int loadData(const char* type, int chan, int dat, int raw);
        int loadData(int chan, int dat, int raw);
+       // Typed bulk load for multi-function modules (e.g. FADC250): all n
+       // words of one pulse quantity on a channel in one call.
+       int loadData(EModuleType type, int chan, const UInt_t* dat, UInt_t n);
 
        // new
        Int_t LoadIfSlot(const UInt_t* evbuffer, const UInt_t *pstop);
@@ -76,6 +79,7 @@ public:
 
 private:
 
+       void reservedataindex(UInt_t numidx);
 
        int crate;
        int slot;
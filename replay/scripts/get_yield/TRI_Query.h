@@ -0,0 +1,498 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// TRI_Query -- count events passing a set of named cuts and fill
+//              histograms for a list of runs, in one pass per run.
+//
+//   TRI_Query query;
+//   query.AddCut("all", cut_L);
+//   query.AddCut("good", cut_e_L);
+//   query.AddHist("z_good", "rpl.z", "good", 200, -0.2, 0.2);
+//   query.Process(RunNoChain);
+//   double n = query.GetCount("good");
+//   TH1D* h = query.GetHist("z_good");   // owned by the caller
+//
+// Each run is read once for all cuts and histograms, instead of once per
+// TTree::GetEntries(cut) or TTree::Draw() call. The expressions are
+// evaluated with TTreeFormula, which reads only the branches they use.
+// Cuts select whole entries, as in TTree::GetEntries(cut); histograms
+// are filled with weight 1 for every instance of the variable in a
+// selected entry.
+//
+// Runs are processed in parallel, one process per run (fork), at most
+// aNJobs at a time (default: one per core). ROOT 5 cannot read trees in
+// several threads safely, separate processes can.
+//
+// The results of every run are cached in <cachedir>/<tree>_<run>.cache,
+// one line per cut or histogram, keyed by its expressions. The cache of
+// a run is dropped when any of its split files changes (modification
+// time or size). A run is only read again if one of the requested cuts
+// or histograms is not in its cache, and then only for those.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <TChain.h>
+#include <TTreeFormula.h>
+#include <TH1D.h>
+#include <TSystem.h>
+#include <TString.h>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*class TRI_Query{{{*/
+class TRI_Query
+{
+	public:
+		TRI_Query(const TString& aCacheDir="query_cache",const TString& aTreeName="T")
+			: CacheDir(aCacheDir), TreeName(aTreeName) {};
+
+		void AddCut(const TString& aName,const TString& aExpr)
+		{
+			Item it;
+			it.Name=aName; it.Expr=aExpr; it.IsHist=kFALSE;
+			it.Nbins=0; it.Low=it.High=0;
+			Items.push_back(it);
+		};
+		// aCut is the name of a cut added with AddCut, or "" for none
+		void AddHist(const TString& aName,const TString& aExpr,const TString& aCut,
+				Int_t aNbins,Double_t aLow,Double_t aHigh)
+		{
+			Item it;
+			it.Name=aName; it.Expr=aExpr; it.Cut=aCut; it.IsHist=kTRUE;
+			it.Nbins=aNbins; it.Low=aLow; it.High=aHigh;
+			Items.push_back(it);
+		};
+
+		inline Int_t Process(const vector<Int_t>& aRunNoChain,Int_t aNJobs=0);
+
+		inline Double_t GetCount(const TString& aCut) const;
+		inline Double_t GetCount(const TString& aCut,Int_t aRunNo) const;
+		inline TH1D* GetHist(const TString& aName) const;
+
+	private:
+		struct Item
+		{
+			TString Name;
+			TString Expr;
+			TString Cut;         // histograms: name of the cut
+			Bool_t IsHist;
+			Int_t Nbins;
+			Double_t Low,High;
+		};
+		// Results of one run: item key -> count, or bin contents 0..Nbins+1
+		// followed by the number of entries
+		typedef map<TString,vector<Double_t> > Results;
+
+		TString CacheDir;
+		TString TreeName;
+		vector<Item> Items;
+		vector<TString> Keys;                // key of each item, set by Process
+		map<Int_t,Results> RunResults;
+
+		inline TString CutExpr(const TString& aName) const;
+		inline TString CacheName(Int_t aRunNo) const;
+		inline vector<TString> FileStamps(const vector<TString>& aFiles) const;
+		inline Bool_t ReadCache(Int_t aRunNo,const vector<TString>& aStamps,Results& oResults) const;
+		inline Bool_t WriteCache(Int_t aRunNo,const vector<TString>& aStamps,const Results& aResults) const;
+		inline Int_t ProcessRun(Int_t aRunNo,const vector<TString>& aFiles,const vector<Int_t>& aItems,Results& ioResults) const;
+};
+/*}}}*/
+
+/*inline TString TRI_Query::CutExpr(const TString& aName) const{{{*/
+inline TString TRI_Query::CutExpr(const TString& aName) const
+{
+	for ( unsigned int i=0; i<Items.size(); i++ )
+		if ( !Items[i].IsHist && Items[i].Name==aName )
+			return Items[i].Expr;
+	if ( aName.Length()>0 )
+		cerr<<Form("       *ERROR*, TRI_Query: no cut named %s, not applying any",aName.Data())<<endl;
+	return "";
+}
+/*}}}*/
+
+/*inline TString TRI_Query::CacheName(Int_t aRunNo) const{{{*/
+inline TString TRI_Query::CacheName(Int_t aRunNo) const
+{
+	return Form("%s/%s_%d.cache",CacheDir.Data(),TreeName.Data(),aRunNo);
+}
+/*}}}*/
+
+/*inline vector<TString> TRI_Query::FileStamps(const vector<TString>& aFiles) const{{{*/
+inline vector<TString> TRI_Query::FileStamps(const vector<TString>& aFiles) const
+{
+	// One "F <mtime> <size> <file>" line per split file
+	vector<TString> stamps;
+	for ( unsigned int i=0; i<aFiles.size(); i++ )
+	{
+		FileStat_t st;
+		if ( gSystem->GetPathInfo(aFiles[i].Data(),st)!=0 )
+			st.fMtime=st.fSize=0;
+		stamps.push_back(Form("F %ld %lld %s",st.fMtime,(Long64_t)st.fSize,aFiles[i].Data()));
+	}
+	return stamps;
+}
+/*}}}*/
+
+/*inline Bool_t TRI_Query::ReadCache(...){{{*/
+inline Bool_t TRI_Query::ReadCache(Int_t aRunNo,const vector<TString>& aStamps,Results& oResults) const
+{
+	// Read the cached results of run aRunNo, if its files are unchanged.
+	// Result lines are "<n> <value_1> ... <value_n>\t<key>".
+
+	oResults.clear();
+	ifstream in(CacheName(aRunNo).Data());
+	if ( !in )
+		return kFALSE;
+	string line;
+	unsigned int nstamp=0;
+	while ( getline(in,line) )
+	{
+		if ( line.empty() || line[0]=='#' )
+			continue;
+		if ( line[0]=='F' )
+		{
+			if ( nstamp>=aStamps.size() || aStamps[nstamp]!=line.c_str() )
+				break;
+			nstamp++;
+			continue;
+		}
+		string::size_type tab=line.find('\t');
+		if ( nstamp!=aStamps.size() || tab==string::npos )
+			break;
+		istringstream vals(line.substr(0,tab));
+		Int_t n=0;
+		vals>>n;
+		vector<Double_t> v(n>0 ? n : 0);
+		for ( Int_t k=0; k<n; k++ )
+			vals>>v[k];
+		if ( !vals )
+			break;
+		oResults[line.substr(tab+1).c_str()]=v;
+	}
+	if ( nstamp!=aStamps.size() || !in.eof() )
+	{
+		// Files changed or damaged cache, start over
+		oResults.clear();
+		return kFALSE;
+	}
+	return kTRUE;
+}
+/*}}}*/
+
+/*inline Bool_t TRI_Query::WriteCache(...){{{*/
+inline Bool_t TRI_Query::WriteCache(Int_t aRunNo,const vector<TString>& aStamps,const Results& aResults) const
+{
+	gSystem->mkdir(CacheDir.Data(),kTRUE);
+	TString name=CacheName(aRunNo);
+	TString tmp=Form("%s.%d",name.Data(),gSystem->GetPid());
+	ofstream out(tmp.Data());
+	if ( !out )
+	{
+		cerr<<Form("       *ERROR*, TRI_Query: cannot write %s",tmp.Data())<<endl;
+		return kFALSE;
+	}
+	out<<"# TRI_Query cache 1, run "<<aRunNo<<endl;
+	for ( unsigned int i=0; i<aStamps.size(); i++ )
+		out<<aStamps[i]<<endl;
+	for ( Results::const_iterator it=aResults.begin(); it!=aResults.end(); ++it )
+	{
+		const vector<Double_t>& v=it->second;
+		out<<v.size();
+		for ( unsigned int k=0; k<v.size(); k++ )
+			out<<" "<<Form("%.17g",v[k]);
+		out<<"\t"<<it->first<<endl;
+	}
+	out.close();
+	if ( !out || rename(tmp.Data(),name.Data())!=0 )
+	{
+		cerr<<Form("       *ERROR*, TRI_Query: cannot write %s",name.Data())<<endl;
+		gSystem->Unlink(tmp.Data());
+		return kFALSE;
+	}
+	return kTRUE;
+}
+/*}}}*/
+
+/*inline Int_t TRI_Query::ProcessRun(...){{{*/
+inline Int_t TRI_Query::ProcessRun(Int_t aRunNo,const vector<TString>& aFiles,const vector<Int_t>& aItems,Results& ioResults) const
+{
+	// Compute the items aItems of run aRunNo in one pass over its files,
+	// adding them to ioResults
+
+	TChain chain(TreeName.Data());
+	for ( unsigned int i=0; i<aFiles.size(); i++ )
+		chain.Add(aFiles[i].Data());
+
+	// One formula per distinct cut expression and per histogram
+	vector<TString> cut_expr;
+	vector<Int_t> item_cut(aItems.size(),-1);
+	for ( unsigned int j=0; j<aItems.size(); j++ )
+	{
+		const Item& it=Items[aItems[j]];
+		TString expr=it.IsHist ? CutExpr(it.Cut) : it.Expr;
+		if ( expr.Length()==0 )
+			continue;
+		unsigned int c=0;
+		while ( c<cut_expr.size() && cut_expr[c]!=expr )
+			c++;
+		if ( c==cut_expr.size() )
+			cut_expr.push_back(expr);
+		item_cut[j]=c;
+	}
+	vector<TTreeFormula*> forms;
+	vector<TTreeFormula*> var(aItems.size(),(TTreeFormula*)0);
+	Int_t bad=0;
+	for ( unsigned int c=0; c<cut_expr.size(); c++ )
+		forms.push_back(new TTreeFormula(Form("cut%d",c),cut_expr[c].Data(),&chain));
+	for ( unsigned int j=0; j<aItems.size(); j++ )
+		if ( Items[aItems[j]].IsHist )
+		{
+			var[j]=new TTreeFormula(Form("var%d",j),Items[aItems[j]].Expr.Data(),&chain);
+			forms.push_back(var[j]);
+		}
+	for ( unsigned int f=0; f<forms.size(); f++ )
+		if ( forms[f]->GetNdim()==0 )
+		{
+			cerr<<Form("       *ERROR*, TRI_Query: bad expression %s",forms[f]->GetTitle())<<endl;
+			bad++;
+		}
+
+	vector<vector<Double_t> > res(aItems.size());
+	for ( unsigned int j=0; j<aItems.size(); j++ )
+		res[j].assign( Items[aItems[j]].IsHist ? Items[aItems[j]].Nbins+3 : 1, 0.0 );
+	vector<Double_t> cut_val(cut_expr.size());
+
+	Long64_t nentries=bad ? 0 : chain.GetEntries();
+	Int_t treenum=-1;
+	for ( Long64_t i=0; i<nentries; i++ )
+	{
+		if ( chain.LoadTree(i)<0 )
+			break;
+		if ( chain.GetTreeNumber()!=treenum )
+		{
+			treenum=chain.GetTreeNumber();
+			for ( unsigned int f=0; f<forms.size(); f++ )
+				forms[f]->UpdateFormulaLeaves();
+		}
+		// An entry passes a cut if any instance of it is non-zero
+		for ( unsigned int c=0; c<cut_expr.size(); c++ )
+		{
+			Int_t n=forms[c]->GetNdata();
+			cut_val[c]=0;
+			for ( Int_t k=0; k<n && cut_val[c]==0; k++ )
+				cut_val[c]=forms[c]->EvalInstance(k);
+		}
+		for ( unsigned int j=0; j<aItems.size(); j++ )
+		{
+			if ( item_cut[j]>=0 && cut_val[item_cut[j]]==0 )
+				continue;
+			const Item& it=Items[aItems[j]];
+			vector<Double_t>& r=res[j];
+			if ( !it.IsHist )
+			{
+				r[0]+=1;
+				continue;
+			}
+			Int_t n=var[j]->GetNdata();
+			for ( Int_t k=0; k<n; k++ )
+			{
+				Double_t x=var[j]->EvalInstance(k);
+				if ( x!=x )
+					continue;
+				Int_t bin;
+				if ( x<it.Low )
+					bin=0;
+				else if ( x>=it.High )
+					bin=it.Nbins+1;
+				else
+					bin=1+Int_t((x-it.Low)/(it.High-it.Low)*it.Nbins);
+				r[bin]+=1;
+				r[it.Nbins+2]+=1;
+			}
+		}
+	}
+	for ( unsigned int f=0; f<forms.size(); f++ )
+		delete forms[f];
+	if ( bad )
+		return -1;
+
+	for ( unsigned int j=0; j<aItems.size(); j++ )
+		ioResults[Keys[aItems[j]]]=res[j];
+	cerr<<Form("      Run %d: %lld entries, %d cut(s)/histogram(s) computed",
+			aRunNo,nentries,(Int_t)aItems.size())<<endl;
+	return 0;
+}
+/*}}}*/
+
+/*inline Int_t TRI_Query::Process(const vector<Int_t>& aRunNoChain,Int_t aNJobs){{{*/
+inline Int_t TRI_Query::Process(const vector<Int_t>& aRunNoChain,Int_t aNJobs)
+{
+	// Compute all cuts and histograms for the runs in aRunNoChain.
+	// Returns the number of runs that could not be processed.
+
+	// Cache key of each item: its expression(s), not its name
+	Keys.clear();
+	for ( unsigned int i=0; i<Items.size(); i++ )
+	{
+		const Item& it=Items[i];
+		if ( it.IsHist )
+			Keys.push_back(Form("H %d %.9g %.9g\t%s\t%s",it.Nbins,it.Low,it.High,
+						it.Expr.Data(),CutExpr(it.Cut).Data()));
+		else
+			Keys.push_back(Form("C\t%s",it.Expr.Data()));
+	}
+	if ( aNJobs<=0 )
+		aNJobs=sysconf(_SC_NPROCESSORS_ONLN);
+	if ( aNJobs<1 )
+		aNJobs=1;
+
+	// Find what is missing from the cache of each run
+	RunResults.clear();
+	Int_t failed=0;
+	vector<Int_t> todo;
+	map<Int_t,vector<TString> > files,stamps;
+	map<Int_t,vector<Int_t> > missing;
+	for ( unsigned int r=0; r<aRunNoChain.size(); r++ )
+	{
+		Int_t run=aRunNoChain[r];
+		if ( RunResults.count(run) )
+			continue;
+		files[run]=gGet_RunFiles(run);
+		if ( files[run].empty() )
+		{
+			cerr<<Form("       *ERROR*, no rootfile founded for Run#%d",run)<<endl;
+			failed++;
+			continue;
+		}
+		stamps[run]=FileStamps(files[run]);
+		Results& res=RunResults[run];
+		ReadCache(run,stamps[run],res);
+		for ( unsigned int i=0; i<Items.size(); i++ )
+			if ( !res.count(Keys[i]) )
+				missing[run].push_back(i);
+		if ( !missing[run].empty() )
+			todo.push_back(run);
+	}
+	cerr<<Form("      TRI_Query: %d run(s), %d to be read, %d at a time",
+			(Int_t)RunResults.size(),(Int_t)todo.size(),aNJobs)<<endl;
+
+	// Read the runs, each in its own process, which leaves its results
+	// in the cache
+	Int_t running=0;
+	for ( unsigned int t=0; t<todo.size(); t++ )
+	{
+		Int_t run=todo[t];
+		if ( aNJobs==1 )
+		{
+			if ( ProcessRun(run,files[run],missing[run],RunResults[run])==0 )
+				WriteCache(run,stamps[run],RunResults[run]);
+			continue;
+		}
+		if ( running==aNJobs )
+		{
+			Int_t st;
+			if ( wait(&st)>0 )
+				running--;
+		}
+		cout.flush(); cerr.flush();
+		pid_t pid=fork();
+		if ( pid==0 )
+		{
+			Results res=RunResults[run];
+			Int_t status=ProcessRun(run,files[run],missing[run],res);
+			if ( status==0 && !WriteCache(run,stamps[run],res) )
+				status=1;
+			_exit(status ? 1 : 0);
+		}
+		else if ( pid<0 )
+			cerr<<Form("       *ERROR*, TRI_Query: cannot start a process for Run#%d",run)<<endl;
+		else
+			running++;
+	}
+	while ( running>0 )
+	{
+		Int_t st;
+		if ( wait(&st)<=0 )
+			break;
+		running--;
+	}
+
+	// Collect the results of the runs that were read
+	for ( unsigned int t=0; t<todo.size(); t++ )
+	{
+		Int_t run=todo[t];
+		Results& res=RunResults[run];
+		if ( aNJobs>1 )
+			ReadCache(run,stamps[run],res);
+		for ( unsigned int i=0; i<Items.size(); i++ )
+			if ( !res.count(Keys[i]) )
+			{
+				cerr<<Form("       *ERROR*, TRI_Query: no results for Run#%d",run)<<endl;
+				RunResults.erase(run);
+				failed++;
+				break;
+			}
+	}
+	return failed;
+}
+/*}}}*/
+
+/*inline Double_t TRI_Query::GetCount(const TString& aCut,Int_t aRunNo) const{{{*/
+inline Double_t TRI_Query::GetCount(const TString& aCut,Int_t aRunNo) const
+{
+	// Number of entries of run aRunNo passing cut aCut
+	map<Int_t,Results>::const_iterator r=RunResults.find(aRunNo);
+	if ( r==RunResults.end() )
+		return 0;
+	for ( unsigned int i=0; i<Items.size() && i<Keys.size(); i++ )
+		if ( !Items[i].IsHist && Items[i].Name==aCut )
+		{
+			Results::const_iterator it=r->second.find(Keys[i]);
+			return ( it!=r->second.end() ) ? it->second[0] : 0;
+		}
+	return 0;
+}
+/*}}}*/
+
+/*inline Double_t TRI_Query::GetCount(const TString& aCut) const{{{*/
+inline Double_t TRI_Query::GetCount(const TString& aCut) const
+{
+	// Number of entries passing cut aCut, summed over all runs
+	Double_t sum=0;
+	for ( map<Int_t,Results>::const_iterator r=RunResults.begin(); r!=RunResults.end(); ++r )
+		sum+=GetCount(aCut,r->first);
+	return sum;
+}
+/*}}}*/
+
+/*inline TH1D* TRI_Query::GetHist(const TString& aName) const{{{*/
+inline TH1D* TRI_Query::GetHist(const TString& aName) const
+{
+	// Histogram aName summed over all runs. Owned by the caller.
+	for ( unsigned int i=0; i<Items.size() && i<Keys.size(); i++ )
+	{
+		const Item& it=Items[i];
+		if ( !it.IsHist || it.Name!=aName )
+			continue;
+		TH1D* h=new TH1D(it.Name.Data(),"",it.Nbins,it.Low,it.High);
+		Double_t entries=0;
+		for ( map<Int_t,Results>::const_iterator r=RunResults.begin(); r!=RunResults.end(); ++r )
+		{
+			Results::const_iterator v=r->second.find(Keys[i]);
+			if ( v==r->second.end() )
+				continue;
+			for ( Int_t b=0; b<=it.Nbins+1; b++ )
+				h->AddBinContent(b,v->second[b]);
+			entries+=v->second[it.Nbins+2];
+		}
+		h->SetEntries(entries);
+		return h;
+	}
+	return 0;
+}
+/*}}}*/
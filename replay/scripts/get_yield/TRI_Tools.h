@@ -117,6 +117,23 @@ inline vector<Int_t> gGet_RunNoChain(const TString& aString)
 }
 /*}}}*/
 
+/*inline vector<TString> gGet_RunFiles(const Int_t aRunNo){{{*/
+inline vector<TString> gGet_RunFiles(const Int_t aRunNo)
+{
+	// Full names of all split files of a run, in order
+	vector<TString> files;
+	Int_t index=0;
+	TString File_Form=Form("%s_%d.root",ROOTFILES_NAME.Data(),aRunNo);
+	while ( gSystem->FindFile(ROOTFILES_DIR.Data(),File_Form) )
+	{
+		files.push_back(File_Form);
+		index++;
+		File_Form=Form("%s_%d_%d.root",ROOTFILES_NAME.Data(),aRunNo,index);
+	}
+	return files;
+}
+/*}}}*/
+
 /*inline TChain* gAddTree(const Int_t aRunNo,const TString& aArm,TString aTreeName="T"){{{*/
 inline TChain* gAddTree(const Int_t aRunNo,TString aTreeName="T")
 {
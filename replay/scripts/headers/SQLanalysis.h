@@ -12,8 +12,10 @@
 #include <iomanip>
 #include <locale>
 #include <algorithm>
+#include <functional>
 #include <array>
 #include <vector>
+#include <map>
 #include "TSQLServer.h"
 #include "TSQLResult.h"
 #include "TSQLRow.h"
@@ -42,6 +44,7 @@
 #include "TProfile.h"
 #include "TFile.h"
 #include "TEventList.h"
+#include "TEntryList.h"
 #include "TSpectrum.h"
 #include "rootalias.h"
 
@@ -50,6 +53,8 @@ const TString mysql_connection = "mysql://halladb/triton-work";
 const TString mysql_user       = "triton-user";
 const TString mysql_password   = "3He3Hdata";
 
+// The helpers below answer from a local copy of the tables, see SQLcache.h
+#include "SQLcache.h"
 
 
 
@@ -66,27 +71,38 @@ struct CODASetting {
   Int_t   bit        = 0; // 2, 5
 };
 
+// row of table <coda> whose run range contains runnum, -1 if none
+Long64_t SQLCodaRow(const SQLMetaCache::Table* t, Int_t runnum){
+  if(!t) return -1;
+  Int_t first = t->Col("first_run"), last = t->Col("last_run");
+  for (size_t i=0; i<t->GetNRows(); i++){
+    const char *f = t->Get(i,first), *l = t->Get(i,last);
+    if(f && l && atoi(f)<runnum && atoi(l)>runnum) return i;
+  }
+  return -1;
+}
+
 CODASetting GetCODASetting(Int_t runnum, Int_t sql=1){
 
   CODASetting coda;
   if(sql){
-    TSQLServer* Server   = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-    TString     query    = Form("select * from coda where `first_run`<%d and `last_run`>%d", runnum, runnum);
-    TSQLResult* result   = Server->Query(query.Data());
-    Server->Close();// Always remember to CLOSE the connection!
-
-    Int_t       nrows    = result->GetRowCount(); 
-    if(nrows==0){
+    SQLMetaCache&        cache = SQLMetaCache::Instance();
+    SQLMetaCache::Table* t     = cache.GetTable("coda");
+    Long64_t             row   = SQLCodaRow(t,runnum);
+    if(row<0 && cache.Missed(runnum)){
+      t   = cache.GetTable("coda");
+      row = SQLCodaRow(t,runnum);
+    }
+    if(row<0){
       cout<< "Error: run "<<runnum<<" does not match any experiment run range in the table <coda>, will use the hard coded setting";
     }  
     else{
-    TSQLRow*    row      = result->Next(); // load row for the corresponding current
-    coda.experiment = row->GetField(2);
-    coda.tsscaler   = row->GetField(3);
-    coda.evscaler   = row->GetField(4);
-    coda.arm        = row->GetField(5);
-    coda.trigger    = row->GetField(6);
-    coda.bit        = atoi(row->GetField(7));
+    coda.experiment = t->Get(row,2);
+    coda.tsscaler   = t->Get(row,3);
+    coda.evscaler   = t->Get(row,4);
+    coda.arm        = t->Get(row,5);
+    coda.trigger    = t->Get(row,6);
+    coda.bit        = atoi(t->Get(row,7));
     return coda;
     }
   }
@@ -125,6 +141,48 @@ CODASetting GetCODASetting(Int_t runnum, Int_t sql=1){
 }
 
 
+// rows of run runnum in table <name>; a run that is not in the local
+// copy makes it read the tables from the server (once), or, if the run
+// is older than the copy, the rows of this run in this table
+SQLMetaCache::Table* SQLRunRows(const TString& name, Int_t runnum, vector<size_t>& rows){
+  SQLMetaCache&        cache = SQLMetaCache::Instance();
+  SQLMetaCache::Table* t     = cache.GetTable(name);
+  rows.clear();
+  if(t) rows = t->Rows(t->Col("run_number"),runnum);
+  if(rows.empty() && (cache.Missed(runnum) || cache.MissedRun(name,runnum))){
+    t = cache.GetTable(name);
+    if(t) rows = t->Rows(t->Col("run_number"),runnum);
+  }
+  return t;
+}
+
+// a field of the run in <experiment>runlist, false if there is none
+Bool_t SQLRunlistField(const CODASetting& coda, Int_t runnum, const char* field, TString& value){
+  vector<size_t>       rows;
+  SQLMetaCache::Table* t = SQLRunRows(coda.experiment+"runlist",runnum,rows);
+  if(!t || rows.empty()) return kFALSE;
+  const char* v = t->Get(rows[0],t->Col(field));
+  if(!v) return kFALSE;
+  value = v;
+  return kTRUE;
+}
+
+// of the rows of table t that pass, the one latest in column timecol, -1 if
+// none pass (as "order by <timecol> desc"). Times are compared as the
+// strings MySQL writes them in.
+template<class Pass>
+Long64_t SQLLatestRow(const SQLMetaCache::Table* t, const char* timecol, Pass pass){
+  if(!t) return -1;
+  Int_t    ct   = t->Col(timecol);
+  Long64_t best = -1;
+  for (size_t i=0; i<t->GetNRows(); i++){
+    if(!pass(i)) continue;
+    const char *tm = t->Get(i,ct), *tb = (best<0) ? nullptr : t->Get(best,ct);
+    if(best<0 || (tm && (!tb || strcmp(tm,tb)>0))) best = i;
+  }
+  return best;
+}
+
 //-------------------------------------------
 //get target info from epics encoder position
 // works for tritium since 2018.1
@@ -148,50 +206,58 @@ struct TargetInfo
 
 TargetInfo GetTargetInfo(TString name, Int_t pos=-999, Int_t runnum=0){
   TargetInfo     target;
-  TString        query;
   CODASetting    coda     = GetCODASetting(runnum);
-
-  
-  if (pos == -999){ 
-    if(runnum>0)// find target name from runlist by runnumber, then get the target info from matching run date
-      query = Form("select * from TargetInfo where name=(select target from %srunlist where run_number=%d)  and time<(select start_time from `%srunlist` where run_number=%d) order by time desc", coda.experiment.Data(), runnum, coda.experiment.Data(),runnum);
-    else // get latest target info given target name
-      query = Form("select * from TargetInfo where name='%s' order by time desc", name.Data());
-    }
-  else{ // find target info given position
-    if(runnum>0)// use run number to locate run date
-      query = Form("select * from TargetInfo where abs(%d-encoder)<encoder_err and time<(select start_time from `%srunlist` where run_number=%d) order by time desc", pos, coda.experiment.Data(),runnum);
-    else // no time info, use the latest target info
-      query = Form("select * from TargetInfo where abs(%d-encoder)<encoder_err order by time desc", pos);
-  }
-  TSQLServer* Server = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-  TSQLResult* result = Server->Query(query.Data());
-  Server->Close();// Always remember to CLOSE the connection!
-  if(result->GetRowCount()==0){
+  TString        start;
+  Bool_t         found    = kTRUE;
+
+  if(runnum>0){ // use run number to locate run date
+    found = SQLRunlistField(coda,runnum,"start_time",start);
+    // find target name from runlist by runnumber, then get the target info from matching run date
+    if(found && pos == -999)
+      found = SQLRunlistField(coda,runnum,"target",name);
+  }
+  SQLMetaCache::Table* t = found ? SQLMetaCache::Instance().GetTable("TargetInfo") : nullptr;
+  Int_t    cname = t ? t->Col("name") : -1;
+  Int_t    cenc  = t ? t->Col("encoder") : -1;
+  Int_t    cerr  = t ? t->Col("encoder_err") : -1;
+  Int_t    ctime = t ? t->Col("time") : -1;
+  // the latest matching entry; by name, or else by position
+  Long64_t row   = SQLLatestRow(t,"time",[&](size_t i){
+      if(pos == -999){
+        const char* n = t->Get(i,cname);
+        if(!n || strcasecmp(n,name.Data())) return false;
+      }
+      else{
+        const char *e = t->Get(i,cenc), *err = t->Get(i,cerr);
+        if(!e || !err || !(fabs(pos-atof(e))<atof(err))) return false;
+      }
+      const char* tm = t->Get(i,ctime);
+      return runnum<=0 || (tm && strcmp(tm,start.Data())<0);
+    });
+  if(row<0){
     cout<<"Error: can not find matched target information from TargetInfo table"<<endl;
     target.pos = pos;
     return target;
   }
-  TSQLRow *row    = result->Next(); // load first row of results
-  target.name     = row->GetField(1); 
-  target.type     = row->GetField(2); 
-  target.pos      = atoi(row->GetField(3)); 
-  target.pos_err  = atoi(row->GetField(4)); 
-  target.tarid    = atoi(row->GetField(15)); 
+  target.name     = t->Get(row,1); 
+  target.type     = t->Get(row,2); 
+  target.pos      = atoi(t->Get(row,3)); 
+  target.pos_err  = atoi(t->Get(row,4)); 
+  target.tarid    = atoi(t->Get(row,15)); 
   if(target.type=="gas"){
-    target.dens_par1 = atof(row->GetField(6)); 
-    target.dens_err1 = atof(row->GetField(7)); 
-    target.dens_par2 = atof(row->GetField(8)); 
-    target.dens_err2 = atof(row->GetField(9));     
+    target.dens_par1 = atof(t->Get(row,6)); 
+    target.dens_err1 = atof(t->Get(row,7)); 
+    target.dens_par2 = atof(t->Get(row,8)); 
+    target.dens_err2 = atof(t->Get(row,9));     
   }
   // get luminosity
-  Double_t rho =  atof(row->GetField(10)); 
+  Double_t rho =  atof(t->Get(row,10)); 
   if(rho>0){
     Double_t avg = 6.02e23;                     // N/mol
     Double_t I   = 1.0;                           // uA = 1e-6 A = 1e-6 C/sec
     Double_t Ne  = 1.0/(1.602e-19) ;               // electrons / C
-    Double_t amu = atof(row->GetField(14));     // g/mol
-    Double_t A   = atof(row->GetField(12));     // g/mol
+    Double_t amu = atof(t->Get(row,14));     // g/mol
+    Double_t A   = atof(t->Get(row,12));     // g/mol
     target.lumi  = rho * avg/amu * A * I *1e-6 *Ne; // #/cm2, for QE and DIS
     target.lumi  = target.lumi /1e-4 * 1e-37 ;  // cm2 to nb
   }
@@ -234,28 +300,23 @@ RunInfo GetRunInfo(Int_t runnum){
   CODASetting coda    = GetCODASetting(runnum);
   RunInfo     runinfo;
 
-  TSQLServer* Server1 = TSQLServer::Connect("mysql://halladb/triton-work","triton-user","3He3Hdata");
-  TString  query1;
-  // find the latest bcm calibration results from database
-  query1=Form("select kin,run_type,quality from `%srunlist` where run_number=%d", coda.experiment.Data(),runnum); // 
-  TSQLResult* result1=Server1->Query(query1.Data());
-  Server1->Close();
+  vector<size_t>       rows;
+  SQLMetaCache::Table* t = SQLRunRows(coda.experiment+"runlist",runnum,rows);
   // skip the run if it's not on the runlist
-  if(result1==0){
+  if(!t || t->Col("kin")<0){
     cout<<"Error: can not find column kin in "<<coda.experiment.Data()<<"runlist!"<<endl;
     return runinfo;
 
   }
-  if(result1->GetRowCount()==0){
+  if(rows.empty()){
     cout<<"Error: can not find run "<<runnum<<" in "<<coda.experiment.Data()<<"runlist!"<<endl;
     return runinfo;
   }
 
   // get the first row 
-  TSQLRow *row1   =    result1->Next();
-  runinfo.kinid   =    row1->GetField(0);
-  runinfo.type    =    row1->GetField(1);
-  runinfo.quality =    row1->GetField(2);
+  runinfo.kinid   =    t->Get(rows[0],t->Col("kin"));
+  runinfo.type    =    t->Get(rows[0],t->Col("run_type"));
+  runinfo.quality =    t->Get(rows[0],t->Col("quality"));
 
   runinfo.kinid.ToLower();
   runinfo.type.ToLower();
@@ -283,25 +344,34 @@ struct AnalysisInfo {
   Int_t    tarid      =  -1;
 };
 
+// rows of the run in <experiment>analysis, highest current first
+SQLMetaCache::Table* SQLAnalysisRows(const CODASetting& coda, Int_t runnum, vector<size_t>& rows){
+  SQLMetaCache::Table* t = SQLRunRows(coda.experiment+"analysis",runnum,rows);
+  if(t){
+    Int_t c = t->Col("current");
+    stable_sort(rows.begin(),rows.end(),[&](size_t a, size_t b){
+        const char *ca = t->Get(a,c), *cb = t->Get(b,c);
+        return ca && (!cb || atof(ca)>atof(cb)); // NULL last, as in MySQL
+      });
+  }
+  return t;
+}
+
 Int_t GetNCurrents(Int_t runnum, Int_t verb=1){
   CODASetting    coda     = GetCODASetting(runnum);
-  AnalysisInfo   runinfo;
-  TSQLServer*    Server   = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-  TString        query    = Form("select current, charge from %sanalysis where run_number=%d order by current desc", coda.experiment.Data(),runnum);
-  TSQLResult*    result   = Server->Query(query.Data());
-  Server->Close();// Always remember to CLOSE the connection!
-  Int_t   nrows = result->GetRowCount(); 
-  Int_t nfields = result->GetFieldCount();
+  vector<size_t> rows;
+  SQLMetaCache::Table* t  = SQLAnalysisRows(coda,runnum,rows);
+  Int_t   nrows = rows.size(); 
+  Int_t   cols[2] = { t ? t->Col("current") : -1, t ? t->Col("charge") : -1 };
   
   if(verb) printf("%20s", "current_id");
-  for (Int_t i = 0; i < nfields; i++)
-    if(verb) printf("%20s", result->GetFieldName(i));
+  for (Int_t i = 0; i < 2; i++)
+    if(verb) printf("%20s", cols[i]<0 ? "" : t->fields[cols[i]].c_str());
   if(verb) cout<<endl;
  for (Int_t j=0; j<nrows; j++){
-    TSQLRow*    row  = result->Next(); // load row for the corresponding current
     if(verb) printf("%20d", j);
-    for (Int_t i = 0; i < nfields; i++)
-      if(verb) printf("%20s", row->GetField(i));
+    for (Int_t i = 0; i < 2; i++)
+      if(verb) printf("%20s", t->Get(rows[j],cols[i]));
     if(verb) cout<<endl;
   }
   return nrows;
@@ -311,11 +381,6 @@ AnalysisInfo GetAnalysisInfo(Int_t runnum, Int_t current_id=0, Int_t verb=1){
   CODASetting    coda     = GetCODASetting(runnum);
   TargetInfo     target   = GetTarget(runnum);
   AnalysisInfo   ana;
-  TSQLServer*    Server   = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-  TString        query    = Form("select * from %sanalysis where run_number=%d order by current desc", coda.experiment.Data(),runnum);
-  TSQLResult*    result   = Server->Query(query.Data());
-  Server->Close();// Always remember to CLOSE the connection!
-  // Int_t nrows = result->GetRowCount();
   Int_t nrows = GetNCurrents(runnum,verb); 
   if(nrows==0){
     cout<<"Error: Can't find run "<<runnum<<" in the table "<<coda.experiment<<"analysis"<<endl;
@@ -328,18 +393,17 @@ AnalysisInfo GetAnalysisInfo(Int_t runnum, Int_t current_id=0, Int_t verb=1){
     return ana;
 
   }
-  TSQLRow *row = nullptr;
-  for (Int_t i=0; i<=current_id; i++){
-    row  = result->Next(); // load row for the corresponding current
-  }
-
-  ana.current    = atof(row->GetField(1)); // get the second column (current)
-  ana.charge     = atof(row->GetField(2)); // get the third  column (charge )
-  ana.trigger    = row->GetField(3); 
-  ana.livetime   = atof(row->GetField(4)); 
-  ana.ntrigger   = atoi(row->GetField(5)); 
-  ana.ntriggered = atoi(row->GetField(6)); 
-  ana.elist      = row->GetField(7); 
+  vector<size_t> rows;
+  SQLMetaCache::Table* t = SQLAnalysisRows(coda,runnum,rows);
+  size_t row = rows[current_id]; // row for the corresponding current
+
+  ana.current    = atof(t->Get(row,1)); // get the second column (current)
+  ana.charge     = atof(t->Get(row,2)); // get the third  column (charge )
+  ana.trigger    = t->Get(row,3); 
+  ana.livetime   = atof(t->Get(row,4)); 
+  ana.ntrigger   = atoi(t->Get(row,5)); 
+  ana.ntriggered = atoi(t->Get(row,6)); 
+  ana.elist      = t->Get(row,7); 
   ana.status     = 1;
   ana.kinid      = GetRunInfo(runnum).kinid;
 
@@ -374,27 +438,32 @@ BCMInfo GetBCMInfo(Int_t runnum, TString bcm_name="dnew"){
   CODASetting coda    = GetCODASetting(runnum);
   BCMInfo     bcm;
 
-  TSQLServer* Server1 = TSQLServer::Connect("mysql://halladb/triton-work","triton-user","3He3Hdata");
-  TString  query1;
-  // find the latest bcm calibration results from database
-  query1=Form("select * from bcm where scaler='%s' and name='%s' and date<(select start_time from `%srunlist` where run_number=%d) order by date desc",coda.evscaler.Data(),bcm_name.Data(), coda.experiment.Data(),runnum); // 
-  TSQLResult* result1=Server1->Query(query1.Data());
-  Server1->Close();
+  // find the latest bcm calibration results before the run
+  TString  start;
+  SQLMetaCache::Table* t = SQLRunlistField(coda,runnum,"start_time",start) ?
+    SQLMetaCache::Instance().GetTable("bcm") : nullptr;
+  Int_t    cscaler = t ? t->Col("scaler") : -1;
+  Int_t    cname   = t ? t->Col("name") : -1;
+  Int_t    cdate   = t ? t->Col("date") : -1;
+  Long64_t row     = SQLLatestRow(t,"date",[&](size_t i){
+      const char *s = t->Get(i,cscaler), *n = t->Get(i,cname), *d = t->Get(i,cdate);
+      return s && n && d && !strcasecmp(s,coda.evscaler.Data()) &&
+        !strcasecmp(n,bcm_name.Data()) && strcmp(d,start.Data())<0;
+    });
   // skip the run if it's not on the runlist
-  if(result1->GetRowCount()==0){
+  if(row<0){
     cout<<"Error: can not find matched BCM information, please check your runlist!"<<endl;
     cout<<"Will use default setting: LHRS scaler dnew calibration from Jan 2018"<<endl;
     return bcm;
   }
 
   // get the first row ( should be before and closest to the run datetime)
-  TSQLRow *row1 =    result1->Next();
-  bcm.scaler    =    row1->GetField(1);
-  bcm.name      =    row1->GetField(2);
-  bcm.gain      =    atof(row1->GetField(3));
-  bcm.gain_err  =    atof(row1->GetField(4));
-  bcm.offset    =    atof(row1->GetField(5));
-  bcm.offset_err=    atof(row1->GetField(6));
+  bcm.scaler    =    t->Get(row,1);
+  bcm.name      =    t->Get(row,2);
+  bcm.gain      =    atof(t->Get(row,3));
+  bcm.gain_err  =    atof(t->Get(row,4));
+  bcm.offset    =    atof(t->Get(row,5));
+  bcm.offset_err=    atof(t->Get(row,6));
 
   return bcm;
 }
@@ -416,12 +485,165 @@ TEventList* GetList(TString path){
   return 0;
 }
 
+  //----------------------
+  // beamtrip cut made during the replay (libraries/TriBeamTrip)
+  //----------------------
+  // entry ranges [first[k],last[k]] of chain t with stable beam at the
+  // current_id-th highest current (0 = highest), from the tree that the
+  // TriBeamTrip module "module" wrote into the rootfiles of the run.
+  // The module stores CODA event numbers, found here in fEvtHdr.fEvtNum of t
+  // by binary search. Loop with t->GetEntry(k) for k in [first[i],last[i]].
+  // The module writes its ranges at the end of every split file it reads,
+  // so each file may hold a copy; only the latest version written by each
+  // analyzer process (one per ParallelReplay segment) is used.
+  // Returns the number of ranges, or -1 if the rootfiles have no ranges
+  // made with this stable_time, or if the charge is asked for a parallel
+  // replay (see IsParallelReplay in rootalias.h).
+Int_t GetBeamTripRanges(TChain* t, Int_t runnum, Int_t current_id, Int_t stable_time,
+                        const char* module, vector<Long64_t>& first, vector<Long64_t>& last,
+                        Double_t* charge=0){
+  first.clear();
+  last.clear();
+  if(charge) *charge = 0;
+  if(!t) return -1;
+  TChain* files = LoadRun(runnum,module);
+  if(!files) return -1;
+  // check every file: the ranges are written into the file that is open
+  // at the end of the replay, and rootfiles from before the module was
+  // added have no such tree
+  TChain* bt = new TChain(module);
+  Bool_t par = kFALSE;
+  TIter next(files->GetListOfFiles());
+  while(TObject* el = next()){
+    TFile* file = TFile::Open(el->GetTitle());
+    if(file && file->Get(module)) bt->Add(el->GetTitle());
+    if(file && file->Get("ParallelReplay")) par = kTRUE;
+    delete file;
+  }
+  delete files;
+  // the charge of a parallel replay is not valid at the segment boundaries
+  if(charge && par){
+    cout<<"Error: run "<<runnum<<" is a parallel replay, its charge cannot be used"<<endl;
+    delete bt;
+    return -1;
+  }
+  if(bt->GetEntries()<=0){
+    delete bt;
+    return -1;
+  }
+
+  Double_t cur,q,st,dev;
+  Long64_t f,l,start;
+  Int_t    version;
+  bt->SetBranchAddress("current"    ,&cur    );
+  bt->SetBranchAddress("first"      ,&f      );
+  bt->SetBranchAddress("last"       ,&l      );
+  bt->SetBranchAddress("charge"     ,&q      );
+  bt->SetBranchAddress("stable_time",&st     );
+  bt->SetBranchAddress("max_dev"    ,&dev    );
+  bt->SetBranchAddress("start"      ,&start  );
+  bt->SetBranchAddress("version"    ,&version);
+  // latest version of each process
+  map<Long64_t,Int_t> latest;
+  for(Long64_t j=0;j<bt->GetEntries();j++){
+    bt->GetEntry(j);
+    if(version>latest[start]) latest[start] = version;
+  }
+  vector<Double_t> rcur,rq;
+  vector<Long64_t> rf,rl;
+  Double_t tol = 0;
+  for(Long64_t j=0;j<bt->GetEntries();j++){
+    bt->GetEntry(j);
+    if(version!=latest[start] || fabs(st-stable_time)>0.01) continue;
+    rcur.push_back(cur); rq.push_back(q);
+    rf.push_back(f);     rl.push_back(l);
+    tol = max(tol,dev);
+  }
+  delete bt;
+  if(rcur.empty()) return -1;
+
+  // current levels, highest first. Each segment of a parallel replay finds
+  // its own levels, so levels within max_dev of each other are the same.
+  vector<Double_t> sorted(rcur), levels;
+  sort(sorted.begin(),sorted.end(),greater<Double_t>());
+  for(size_t i=0;i<sorted.size();i++)
+    if(levels.empty() || levels.back()-sorted[i]>tol) levels.push_back(sorted[i]);
+  if(current_id<0 || current_id>=(Int_t)levels.size()){
+    cout<<"Error: run "<<runnum<<" has no current level "<<current_id<<endl;
+    return 0;
+  }
+  Double_t hi = levels[current_id];
+  Double_t lo = (current_id+1<(Int_t)levels.size()) ? levels[current_id+1] : -1;
+  vector<pair<Long64_t,Long64_t> > ranges;
+  for(size_t i=0;i<rcur.size();i++){
+    if(rcur[i]>hi || rcur[i]<=lo) continue;
+    ranges.push_back(make_pair(rf[i],rl[i]));
+    if(charge) *charge += rq[i];
+  }
+  sort(ranges.begin(),ranges.end());
+
+  // event numbers -> entries
+  TChain ev(t->GetName());
+  ev.Add(t);
+  ev.SetBranchStatus("*",0);
+  ev.SetBranchStatus("fEvtHdr.fEvtNum",1);
+  UInt_t   evnum = 0;
+  ev.SetBranchAddress("fEvtHdr.fEvtNum",&evnum);
+  Long64_t n     = ev.GetEntries();
+  // first entry from 'from' on with event number >= target
+  auto lower = [&](Long64_t from, Long64_t target){
+    Long64_t to = n;
+    while(from<to){
+      Long64_t mid = from+(to-from)/2;
+      ev.GetEntry(mid);
+      if((Long64_t)evnum<target) from = mid+1;
+      else                       to   = mid;
+    }
+    return from;
+  };
+  Long64_t pos = 0;
+  for(size_t i=0;i<ranges.size();i++){
+    Long64_t e1 = lower(pos,ranges[i].first);
+    Long64_t e2 = lower(e1,ranges[i].second+1);
+    if(e2>e1){
+      first.push_back(e1);
+      last.push_back(e2-1);
+    }
+    pos = e2;
+  }
+  return first.size();
+}
+
+  // the same as entry list, for t->SetEntryList(), t->Draw() etc. This
+  // enters every event; loops over the events are faster with the ranges.
+TEntryList* GetBeamTripList(TChain* t, Int_t runnum, Int_t current_id, Int_t stable_time,
+                            const char* module){
+  vector<Long64_t> first,last;
+  if(GetBeamTripRanges(t,runnum,current_id,stable_time,module,first,last)<0) return 0;
+  TEntryList* elist = new TEntryList("elist",Form("%s cut",module));
+  for(size_t i=0;i<first.size();i++)
+    for(Long64_t e=first[i];e<=last[i];e++)
+      elist->Enter(e,t);
+  return elist;
+}
+
   // highest currrent has id 0, default cut on 5 seconds after beam stablized
+  // uses the cut made during the replay if the rootfiles have it,
+  // otherwise the eventlist files made by beam/beamtrip_sql.C.
+  // The entry list is for TTree::Draw and friends; to loop over the events,
+  // GetBeamTripRanges() gives the ranges to read without the entry list.
 TChain *LoadList(Int_t runnum, Int_t current_id=0, Int_t stable_time=5){
   TChain*         t    = LoadRun(runnum);
+  CODASetting     coda = GetCODASetting(runnum);
+  TString      module  = (coda.arm=="R") ? "RightBeamTrip" : "LeftBeamTrip";
+  TEntryList*  entries = GetBeamTripList(t,runnum,current_id,stable_time,module);
+  if(entries){
+    cout<<"will apply beamtrip cut from "<<module<<" in the rootfiles"<<endl;
+    t->SetEntryList(entries);
+    return t;
+  }
   // read info from SQL
   AnalysisInfo    ana  = GetAnalysisInfo(runnum, current_id);
-  CODASetting     coda = GetCODASetting(runnum);
   if(ana.status < 1){
     cout<<"Error: can not find run "<<runnum<<" in analysis table! No beamtrip cut applied\n";
     return t;
@@ -574,21 +796,14 @@ string cols ="livetime, trigger_counts, trigger_events";
   double correction=1.0;
   correction_error=0.0;
   CODASetting   coda     = GetCODASetting(runnum);
-  AnalysisInfo  runinfo;
-  TSQLServer*  	Server   = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-  TString 	query    = Form("select %s from %sanalysis where run_number=%d",cols.c_str(), coda.experiment.Data(),runnum);
-  TSQLResult*   result   = Server->Query(query.Data());
-  Server->Close();
-  if(result->GetRowCount()==0){cout << "No corrections "<<"\n"; return correction;} 
-  TSQLRow *row = result->Next();
+  vector<size_t>       rows;
+  SQLMetaCache::Table* t = SQLRunRows(coda.experiment+"analysis",runnum,rows);
+  if(rows.empty()){cout << "No corrections "<<"\n"; return correction;} 
+  size_t row = rows[0];
 /////I can Add these in as I get more corrections into the DB
- int count = result->GetFieldCount();
-/* for(int i=0; i<count;i++){
-    	cout<<result->GetFieldName(i)<<endl;
-	}*/
 //Livetime
- correction *= atof(row->GetField(0));
- correction_error = Binomial_Error(correction,atoi(row->GetField(1)));
+ correction *= atof(t->Get(row,t->Col("livetime")));
+ correction_error = Binomial_Error(correction,atoi(t->Get(row,t->Col("trigger_counts"))));
 ///
   return correction;
 }
@@ -598,12 +813,9 @@ string cols ="livetime, trigger_counts, trigger_events";
 int SQLRunlistStatus(int runnum)
 {
   CODASetting   coda     = GetCODASetting(runnum);
-  AnalysisInfo  runinfo;
-  TSQLServer*   Server   = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-  TString       query    = Form("select run_number from %srunlist where run_number=%d", coda.experiment.Data(),runnum);
-  TSQLResult*   result   = Server->Query(query.Data());
-  Server->Close();
-  if(result->GetRowCount()==0){cout << "Run list does not contain this run "<<"\n"; return 0;}
+  vector<size_t> rows;
+  SQLRunRows(coda.experiment+"runlist",runnum,rows);
+  if(rows.empty()){cout << "Run list does not contain this run "<<"\n"; return 0;}
   else{return 1;}
 }
 
@@ -622,20 +834,18 @@ struct RunInfo{
 RunInfo GetRunInfo(int runnum){
 	RunInfo runinfo;
 	CODASetting   coda     = GetCODASetting(runnum);
-  	TSQLServer*   Server   = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
-  	TString       query    = Form("select run_number,target,run_type,Kinematic,time_mins, prescale_T%d from %srunlist where run_number=%d", coda.bit,coda.experiment.Data(),runnum);
-  	TSQLResult*   result   = Server->Query(query.Data());
-	Server->Close();
-  	if(result->GetRowCount()==0){cout << "Not in list\n";return runinfo;}
-	TSQLRow *row = result->Next();	
+	vector<size_t> rows;
+	SQLMetaCache::Table* t = SQLRunRows(coda.experiment+"runlist",runnum,rows);
+  	if(rows.empty()){cout << "Not in list\n";return runinfo;}
+	size_t row = rows[0];	
 	runinfo.runnum=runnum;
-	runinfo.target=row->GetField(1);
-	runinfo.type=row->GetField(2);
-	runinfo.kinematic=row->GetField(3);
-//	cout<< row->GetField(4) <<endl;
-	if(row->GetField(4)==nullptr){runinfo.time_mins=1000000000000;}
-	else{runinfo.time_mins=atof(row->GetField(4));}
-	runinfo.PS_main=atoi(row->GetField(5));	
+	runinfo.target=t->Get(row,t->Col("target"));
+	runinfo.type=t->Get(row,t->Col("run_type"));
+	runinfo.kinematic=t->Get(row,t->Col("Kinematic"));
+//	cout<< t->Get(row,t->Col("time_mins")) <<endl;
+	if(t->Get(row,t->Col("time_mins"))==nullptr){runinfo.time_mins=1000000000000;}
+	else{runinfo.time_mins=atof(t->Get(row,t->Col("time_mins")));}
+	runinfo.PS_main=atoi(t->Get(row,t->Col(Form("prescale_T%d",coda.bit))));	
 	if(runinfo.PS_main>0){
 		if(runinfo.type!="Cosmic" && runinfo.time_mins>2.0){
 			runinfo.good_run=1;}
@@ -0,0 +1,392 @@
+// For tritium
+// Local copy of the run metadata tables of the SQL database, used by the
+// helpers in SQLanalysis.h instead of one server connection per query.
+//
+// The tables coda, TargetInfo, bcm, <experiment>runlist and
+// <experiment>analysis are read in bulk (one connection, one
+// "select *" per table) and kept in memory. They are also written to a
+// snapshot file, so that later jobs (e.g. on the farm) start from the
+// file and do not need the server at all:
+//
+//   TRI_SQL_CACHE      snapshot file  (default sql_cache/triton-work.txt)
+//   TRI_SQL_CACHE_AGE  seconds after which the snapshot is refreshed
+//                      (default 3600)
+//
+// A snapshot older than that is still used, and a background process
+// (fork) fetches a new one from the server and replaces the file when
+// done; a running job picks it up at its next lookup. Only if there is no
+// snapshot at all is the server queried before the first answer. If the
+// server cannot be reached, the snapshot is used however old it is.
+// A run newer than all runs in the snapshot (e.g. a run just taken) makes
+// the cache fetch the tables from the server, once per process. A run
+// that is known but has no rows in one table (e.g. analysis results
+// written after the snapshot was taken) makes it query that table for
+// that run only, once per table and run as long as the same snapshot is
+// loaded; if the server cannot be reached, it is not asked again until a
+// new snapshot is loaded.
+//
+// The snapshot is a text file, one "T <table> <nfields> <nrows>" line
+// per table followed by the field names and the rows, tab separated;
+// NULL is written as \N.
+//
+// Included by SQLanalysis.h, whose connection settings it uses.
+
+#ifndef SQLCACHE_H
+#define SQLCACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "TSQLServer.h"
+#include "TSQLResult.h"
+#include "TSQLRow.h"
+#include "TString.h"
+#include "TSystem.h"
+
+using namespace std;
+
+class SQLMetaCache {
+public:
+  struct Table {
+    vector<string>          fields;
+    vector<vector<string> > cells;
+    vector<vector<char> >   isnull;
+    map<Int_t, map<Long64_t, vector<size_t> > > index; // [column][value] -> rows
+
+    size_t GetNRows() const { return cells.size(); }
+    // column number of a field (case insensitive as in MySQL), -1 if none
+    Int_t Col(const char* name) const {
+      for (size_t i=0; i<fields.size(); i++)
+        if (!strcasecmp(fields[i].c_str(),name)) return i;
+      return -1;
+    }
+    // field value, nullptr for NULL as TSQLRow::GetField
+    const char* Get(size_t row, Int_t col) const {
+      if (col<0 || col>=(Int_t)fields.size() || isnull[row][col]) return nullptr;
+      return cells[row][col].c_str();
+    }
+    // rows where the integer column col equals value
+    const vector<size_t>& Rows(Int_t col, Long64_t value) {
+      static const vector<size_t> none;
+      if (col<0) return none;
+      map<Long64_t, vector<size_t> >& idx = index[col];
+      if (idx.empty())
+        for (size_t i=0; i<cells.size(); i++)
+          if (!isnull[i][col]) idx[atoll(cells[i][col].c_str())].push_back(i);
+      map<Long64_t, vector<size_t> >::const_iterator it = idx.find(value);
+      return (it==idx.end()) ? none : it->second;
+    }
+  };
+
+  static SQLMetaCache& Instance() {
+    static SQLMetaCache cache;
+    return cache;
+  }
+
+  // A table, or nullptr if it is neither in the snapshot nor on the
+  // server. The pointer is valid until the next call to GetTable.
+  Table* GetTable(const TString& name) {
+    CheckFile();
+    map<string,Table>::iterator it = fTables.find(name.Data());
+    return (it==fTables.end()) ? nullptr : &it->second;
+  }
+
+  // Called when run runnum was not found: if it is newer than the
+  // snapshot, fetch the tables from the server, at most once per process.
+  // True if they were fetched.
+  Bool_t Missed(Int_t runnum) {
+    if (fFetched || runnum<=fMaxRun) return kFALSE;
+    cout << "SQLMetaCache: run not in the snapshot, reading the tables from the server" << endl;
+    return Refresh();
+  }
+
+  // Called when run runnum has no rows in table name: read them from the
+  // server, once per table and run for the loaded snapshot, and not at all
+  // once the server was found to be down. True if rows were found.
+  Bool_t MissedRun(const TString& name, Int_t runnum) {
+    if (fServerDown) return kFALSE;
+    if (!fRunQueries.insert(Form("%s %d",name.Data(),runnum)).second) return kFALSE;
+    TSQLServer* server = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
+    if (!server || !server->IsConnected()) {
+      delete server;
+      fServerDown = kTRUE;
+      return kFALSE;
+    }
+    Table rows;
+    Bool_t ok = FetchTable(server,name,rows,Form(" where run_number=%d",runnum));
+    server->Close();
+    delete server;
+    if (!ok || rows.GetNRows()==0) return kFALSE;
+    Table& t = fTables[name.Data()];
+    if (t.fields.empty()) t.fields = rows.fields;
+    if (t.fields!=rows.fields) return kFALSE; // table changed on the server
+    t.cells.insert(t.cells.end(),rows.cells.begin(),rows.cells.end());
+    t.isnull.insert(t.isnull.end(),rows.isnull.begin(),rows.isnull.end());
+    t.index.clear();
+    if (runnum>fMaxRun) fMaxRun = runnum;
+    return kTRUE;
+  }
+
+  // Fetch all tables from the server now and write the snapshot
+  Bool_t Refresh() {
+    fFetched = kTRUE;
+    map<string,Table> tables;
+    if (!Fetch(tables)) return kFALSE;
+    fTables.swap(tables);
+    Save(fTables);
+    fFileTime = FileTime();
+    NewSnapshot();
+    return kTRUE;
+  }
+
+  const TString& GetFileName() const { return fFile; }
+
+private:
+  TString            fFile;      // snapshot file
+  Long_t             fMaxAge;    // refresh the snapshot after that many seconds
+  map<string,Table>  fTables;
+  time_t             fFileTime;  // modification time of the loaded snapshot
+  time_t             fLastCheck; // last time the file was checked for a newer snapshot
+  Bool_t             fFetched;   // tables fetched from the server by this process
+  Int_t              fMaxRun;    // highest run number in the tables
+  set<string>        fRunQueries;// "<table> <run>" asked by MissedRun for this snapshot
+  Bool_t             fServerDown;// server not reachable by MissedRun for this snapshot
+
+  SQLMetaCache() : fMaxAge(3600), fFileTime(0), fLastCheck(0), fFetched(kFALSE), fMaxRun(0),
+                   fServerDown(kFALSE) {
+    const char* env = gSystem->Getenv("TRI_SQL_CACHE");
+    fFile = (env && *env) ? env : "sql_cache/triton-work.txt";
+    env = gSystem->Getenv("TRI_SQL_CACHE_AGE");
+    if (env && *env) fMaxAge = atol(env);
+
+    // load into a temporary, so that a partly read file is not used
+    map<string,Table> tables;
+    if (Load(fFile,tables)) {
+      fTables.swap(tables);
+      fFileTime = FileTime();
+      fLastCheck = time(0);
+      NewSnapshot();
+      if (time(0)-fFileTime > fMaxAge) StartRefresh();
+    }
+    else if (!Refresh())
+      cout << "SQLMetaCache: Error: no snapshot " << fFile
+           << " and the server cannot be reached" << endl;
+  }
+
+  time_t FileTime() const {
+    struct stat st;
+    return (stat(fFile.Data(),&st)==0) ? st.st_mtime : 0;
+  }
+
+  // reload the snapshot if a background refresh has replaced it
+  void CheckFile() {
+    time_t now = time(0);
+    if (now-fLastCheck < 60) return;
+    fLastCheck = now;
+    time_t t = FileTime();
+    if (t==0 || t==fFileTime) return;
+    map<string,Table> tables;
+    if (Load(fFile,tables)) {
+      fTables.swap(tables);
+      fFileTime = t;
+      NewSnapshot();
+    }
+  }
+
+  // A new snapshot is loaded: runs missing from the old one may be in it,
+  // and the server may be back
+  void NewSnapshot() {
+    SetMaxRun();
+    fRunQueries.clear();
+    fServerDown = kFALSE;
+  }
+
+  void SetMaxRun() {
+    fMaxRun = 0;
+    for (map<string,Table>::const_iterator it=fTables.begin(); it!=fTables.end(); ++it) {
+      const Table& t = it->second;
+      Int_t col = t.Col("run_number");
+      for (size_t i=0; col>=0 && i<t.GetNRows(); i++)
+        if (t.Get(i,col) && atoi(t.Get(i,col))>fMaxRun) fMaxRun = atoi(t.Get(i,col));
+    }
+  }
+
+  // Refresh the snapshot in a detached process (double fork, so that no
+  // zombie is left behind). A lock file keeps concurrent jobs from all
+  // doing the same.
+  void StartRefresh() {
+    TString lock = fFile+".lock";
+    int fd = open(lock.Data(),O_CREAT|O_EXCL|O_WRONLY,0644);
+    if (fd<0) {
+      struct stat st;
+      if (stat(lock.Data(),&st)==0 && time(0)-st.st_mtime < 600) return;
+      unlink(lock.Data()); // left over from a refresh that died
+      fd = open(lock.Data(),O_CREAT|O_EXCL|O_WRONLY,0644);
+      if (fd<0) return;
+    }
+    close(fd);
+    cout.flush();
+    pid_t pid = fork();
+    if (pid==0) {
+      if (fork()==0) {
+        map<string,Table> tables;
+        if (Fetch(tables)) Save(tables);
+        unlink(lock.Data());
+        _exit(0);
+      }
+      _exit(0);
+    }
+    else if (pid>0)
+      waitpid(pid,0,0);
+    else
+      unlink(lock.Data());
+  }
+
+  static Bool_t FetchTable(TSQLServer* server, const TString& name, Table& t, const char* where="") {
+    TSQLResult* result = server->Query(Form("select * from `%s`%s",name.Data(),where));
+    if (!result) return kFALSE;
+    Int_t nfields = result->GetFieldCount();
+    for (Int_t i=0; i<nfields; i++) t.fields.push_back(result->GetFieldName(i));
+    TSQLRow* row;
+    while ((row = result->Next())) {
+      t.cells.push_back(vector<string>(nfields));
+      t.isnull.push_back(vector<char>(nfields,0));
+      for (Int_t i=0; i<nfields; i++) {
+        const char* f = row->GetField(i);
+        if (f) t.cells.back()[i] = f;
+        else   t.isnull.back()[i] = 1;
+      }
+      delete row;
+    }
+    delete result;
+    return kTRUE;
+  }
+
+  static Bool_t Fetch(map<string,Table>& tables) {
+    TSQLServer* server = TSQLServer::Connect(mysql_connection.Data(),mysql_user.Data(),mysql_password.Data());
+    if (!server || !server->IsConnected()) {
+      delete server;
+      return kFALSE;
+    }
+    Bool_t ok = FetchTable(server,"coda",tables["coda"]);
+    if (ok) {
+      // one runlist and analysis table per experiment in <coda>
+      vector<string> exps(1,"MARATHON");
+      const Table& coda = tables["coda"];
+      for (size_t i=0; i<coda.GetNRows(); i++) {
+        const char* exp = coda.Get(i,2);
+        if (exp && find(exps.begin(),exps.end(),exp)==exps.end()) exps.push_back(exp);
+      }
+      for (size_t i=0; i<exps.size(); i++) {
+        TString run = exps[i]+"runlist", ana = exps[i]+"analysis";
+        if (!FetchTable(server,run,tables[run.Data()])) tables.erase(run.Data());
+        if (!FetchTable(server,ana,tables[ana.Data()])) tables.erase(ana.Data());
+      }
+      if (!FetchTable(server,"TargetInfo",tables["TargetInfo"])) tables.erase("TargetInfo");
+      if (!FetchTable(server,"bcm",tables["bcm"])) tables.erase("bcm");
+    }
+    server->Close();// Always remember to CLOSE the connection!
+    delete server;
+    return ok;
+  }
+
+  static string Escape(const string& s) {
+    string out;
+    for (size_t i=0; i<s.size(); i++) {
+      switch (s[i]) {
+      case '\\': out += "\\\\"; break;
+      case '\t': out += "\\t";  break;
+      case '\n': out += "\\n";  break;
+      case '\r': out += "\\r";  break;
+      default:   out += s[i];
+      }
+    }
+    return out;
+  }
+
+  // split a line at tabs and undo Escape; null[i] is set for \N
+  static void Split(const string& line, vector<string>& out, vector<char>& null) {
+    out.assign(1,string());
+    null.assign(1,0);
+    for (size_t i=0; i<line.size(); i++) {
+      char c = line[i];
+      if (c=='\t') { out.push_back(string()); null.push_back(0); continue; }
+      if (c=='\\' && i+1<line.size()) {
+        c = line[++i];
+        if      (c=='t') c = '\t';
+        else if (c=='n') c = '\n';
+        else if (c=='r') c = '\r';
+        else if (c=='N') { null.back() = 1; continue; }
+      }
+      out.back() += c;
+    }
+  }
+
+  Bool_t Load(const TString& file, map<string,Table>& tables) const {
+    ifstream in(file.Data());
+    if (!in) return kFALSE;
+    string line;
+    vector<char> null;
+    while (getline(in,line)) {
+      if (line.empty() || line[0]=='#') continue;
+      char name[256];
+      Int_t nfields, nrows;
+      if (sscanf(line.c_str(),"T %255s %d %d",name,&nfields,&nrows)!=3) return kFALSE;
+      Table& t = tables[name];
+      if (!getline(in,line)) return kFALSE;
+      Split(line,t.fields,null);
+      if ((Int_t)t.fields.size()!=nfields) return kFALSE;
+      t.cells.resize(nrows);
+      t.isnull.resize(nrows);
+      for (Int_t i=0; i<nrows; i++) {
+        if (!getline(in,line)) return kFALSE;
+        Split(line,t.cells[i],t.isnull[i]);
+        if ((Int_t)t.cells[i].size()!=nfields) return kFALSE;
+      }
+    }
+    return !tables.empty();
+  }
+
+  // write to a temporary file and rename, so readers never see half a file
+  Bool_t Save(const map<string,Table>& tables) const {
+    TString dir = gSystem->DirName(fFile);
+    gSystem->mkdir(dir,kTRUE);
+    TString tmp = Form("%s.%d",fFile.Data(),(Int_t)getpid());
+    ofstream out(tmp.Data());
+    if (!out) return kFALSE;
+    time_t now = time(0);
+    out << "# " << mysql_connection << " snapshot, " << ctime(&now);
+    for (map<string,Table>::const_iterator it=tables.begin(); it!=tables.end(); ++it) {
+      const Table& t = it->second;
+      out << "T " << it->first << " " << t.fields.size() << " " << t.GetNRows() << "\n";
+      for (size_t i=0; i<t.fields.size(); i++)
+        out << (i ? "\t" : "") << Escape(t.fields[i]);
+      out << "\n";
+      for (size_t j=0; j<t.GetNRows(); j++) {
+        for (size_t i=0; i<t.fields.size(); i++)
+          out << (i ? "\t" : "") << (t.isnull[j][i] ? string("\\N") : Escape(t.cells[j][i]));
+        out << "\n";
+      }
+    }
+    out.close();
+    if (!out || rename(tmp.Data(),fFile.Data())!=0) {
+      unlink(tmp.Data());
+      return kFALSE;
+    }
+    return kTRUE;
+  }
+};
+
+#endif
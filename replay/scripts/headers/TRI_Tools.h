@@ -201,6 +201,25 @@ inline TChain* gGetTree(const vector<Int_t>& aRunNoChain, TString aTreeName="T")
 }
 /*}}}*/
 
+/*inline Bool_t gIsParallelReplay(TChain* aTree){{{*/
+inline Bool_t gIsParallelReplay(TChain* aTree)
+{
+	// A rootfile merged by ParallelReplay.C from several segments holds a
+	// TNamed "ParallelReplay"; its BCM charge is not valid at the segment
+	// boundaries, so it must not be used for charge normalization.
+	if ( !aTree ) return kFALSE;
+	TIter next(aTree->GetListOfFiles());
+	while ( TObject* el=next() )
+	{
+		TFile* file=TFile::Open(el->GetTitle());
+		Bool_t par=( file && file->Get("ParallelReplay") );
+		delete file;
+		if ( par ) return kTRUE;
+	}
+	return kFALSE;
+}
+/*}}}*/
+
 /*inline int gGet_TargetInfo(TString aTarget_Name){{{*/
 inline int gGet_TargetInfo(const TString &aTarget_Name, int* aA, int* aZ, double* aThickness, double* aThickness_Err)
 {
@@ -158,6 +158,25 @@ TCut acc_cut_R_e = dp_cut_R_e+th_cut_R_e+ph_cut_R_e+z_cut_R;//+aperture_L;
 
 
 
+//--------------------------------
+// Rootfiles merged by ParallelReplay.C from more than one segment hold a
+// TNamed "ParallelReplay": their BCM charge/current and scaler rates are
+// not valid at the segment boundaries, so they must not be used for
+// charge normalization. True if any file of the chain is one of them.
+//--------------------------------
+Bool_t IsParallelReplay(TChain* tt)
+{
+  if (!tt) return kFALSE;
+  TIter next(tt->GetListOfFiles());
+  while (TObject* el = next()) {
+    TFile* file = TFile::Open(el->GetTitle());
+    Bool_t par  = (file && file->Get("ParallelReplay"));
+    delete file;
+    if (par) return kTRUE;
+  }
+  return kFALSE;
+}
+
 //--------------------------------
 // Chain rootfiles given run number, taken from Longwu Ou's GMP code
 //--------------------------------
@@ -191,6 +210,9 @@ TChain* LoadRun(Int_t run, const char* path, const char* tree, Int_t skim=0, Int
    delete tt;
    tt = 0;
   }
+  else if (IsParallelReplay(tt))
+    cout << "Warning: run " << run << " is a parallel replay, its BCM charge/current"
+         << " and scaler rates are not valid at the segment boundaries" << endl;
 
   return tt;
 }
@@ -15,6 +15,8 @@
 #include "evio.h"
 #include "THaEvData.h"
 
+class THaEpicsSnapshot;
+
 class THaCodaDecoder : public THaEvData {
  public:
   THaCodaDecoder();
@@ -34,6 +36,8 @@ class THaCodaDecoder : public THaEvData {
   double GetEpicsData(const char* tag, int event=0) const;
   double GetEpicsTime(const char* tag, int event=0) const;
   std::string GetEpicsString(const char* tag, int event=0) const;
+// All EPICS channels at once, nearest CODA event# 'event'
+  void GetEpicsSnapshot(int event, THaEpicsSnapshot& snap) const;
 
   virtual void SetRunTime(UInt_t tloc);
 
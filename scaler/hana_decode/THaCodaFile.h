@@ -34,10 +34,13 @@ public:
   int codaRead(); 
   int codaWrite(const int* evbuffer);
   int *getEvBuffer();     
+  int codaTell(long& offset);                // file position of the next event
+  int codaSeek(long offset);                 // go to a position from codaTell
   int filterToFile(const char* output_file); // filter to an output file
   void addEvTypeFilt(int evtype_to_filt);    // add an event type to list
   void addEvListFilt(int event_to_filt);     // add an event num to list
   void setMaxEvFilt(int max_event);          // max num events to filter
+  void setKeepNonPhysFilt(int keep=1);       // always keep non-physics events
   virtual bool isOpen() const;
 
 private:
@@ -49,6 +52,7 @@ private:
   void staterr(const char* tried_to, int status);  // Can cause job to exit(0)
   int ffirst;
   int max_to_filt,handle;
+  int keep_nonphys;
   int maxflist,maxftype;
   TArrayI evlist, evtypes;
 
@@ -0,0 +1,69 @@
+#ifndef THaCodaIndex_h
+#define THaCodaIndex_h
+
+/////////////////////////////////////////////////////////////////////
+//
+//  THaCodaIndex
+//  Event index of a CODA run
+//
+//  Maps event numbers to (segment, byte offset) over all split
+//  files of a run (run.dat.0, run.dat.1, ...), so that reading can
+//  start at any event without reading through the ones before it.
+//  Physics events are indexed every 'stride' events, all other
+//  events (control, scaler, EPICS, ...) always.
+//
+//  The index lives in a small text file next to the data, see
+//  SidecarName().  It is made by AddSegment() + Write(), or with
+//  the codaindex program.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TString.h"
+#include <vector>
+
+class THaCodaFile;
+
+class THaCodaIndex {
+
+public:
+
+  struct Entry {
+    int  segment;   // split file number
+    int  evnum;     // event number; for non-physics events the last one
+    int  evtype;
+    long offset;    // byte offset of the event in its split file
+  };
+
+  THaCodaIndex(int stride=1000);
+  virtual ~THaCodaIndex();
+
+  int  AddSegment(const char* fname);        // index the next split file
+  int  Write(const char* fname) const;
+  int  Read(const char* fname);
+  void Clear();
+
+  const Entry* Find(int evnum) const;        // where to start for event evnum
+  int  GoToEvent(THaCodaFile& file, int evnum) const;
+
+  int  GetNSegments() const { return fSegments.size(); }
+  const char* GetSegmentName(int segment) const;
+  int  GetNEntries() const { return fEntries.size(); }
+  const Entry& GetEntry(int i) const { return fEntries[i]; }
+  int  GetStride() const { return fStride; }
+
+  static TString SidecarName(const char* segment0);
+
+private:
+
+  static bool IsPhysics(int evtype) { return evtype > 0 && evtype <= 14; }
+
+  int fStride;
+  std::vector<TString> fSegments;
+  std::vector<Entry>   fEntries;   // in file order
+
+  ClassDef(THaCodaIndex,0)   // Event index of a CODA run
+
+};
+
+#endif
@@ -52,6 +52,7 @@ class THaCrateMap
      int getNslot(int crate) const;                 // Returns num occupied slots
      UShort_t getNchan(int crate, int slot) const;  // Max number of channels
      UShort_t getNdata(int crate, int slot) const;  // Max number of data words
+     UShort_t getNhit(int crate, int slot) const;   // Max hits per channel (0=any)
      bool slotDone(int slot) const;                       // Used to speed up decoder
      bool crateUsed(int crate) const;               // True if crate is used
      bool slotUsed(int crate, int slot) const;      // True if slot in crate is used
@@ -86,6 +87,7 @@ class THaCrateMap
      int headmask[MAXROC][MAXSLOT];   // Mask for header signature bits
      UShort_t nchan[MAXROC][MAXSLOT]; // Number of channels for device
      UShort_t ndata[MAXROC][MAXSLOT]; // Number of datawords
+     UShort_t nhit[MAXROC][MAXSLOT];  // Max hits per channel, 0 if not fixed
      TString scalerloc[MAXROC];
      void incrNslot(int crate);
      void setUsed(int crate,int slot);
@@ -202,6 +204,16 @@ UShort_t THaCrateMap::getNdata(int crate, int slot) const {
   return ndata[crate][slot];
 }
 
+inline
+UShort_t THaCrateMap::getNhit(int crate, int slot) const {
+#ifdef CHECK_RANGE
+  if (crate < 0 || crate >= MAXROC ||
+      slot < 0  || slot  >= MAXSLOT )
+    return CM_ERR;
+#endif
+  return nhit[crate][slot];
+}
+
 inline
 int THaCrateMap::getNslot(int crate) const {
 #ifdef CHECK_RANGE
@@ -28,7 +28,7 @@ public:
   };
   Double_t GetData() const { return dvalue; };
   Int_t GetEvNum() const   { return evnum;  };
-  std::string GetTag() const    { return tag;    };
+  const std::string& GetTag() const { return tag; };
   std::string GetDate() const   { return dtime;  };
   Double_t GetTimeStamp() const { return timestamp; };
   void MakeTime() {
@@ -52,6 +52,29 @@ private:
 
 typedef std::map< std::string, std::vector<EpicsChan> >::value_type epVal;
 
+class THaEpicsSnapshot {
+// All EPICS channels at one event, see THaEpics::GetSnapshot.
+// Holds copies of the data, so it stays valid while more EPICS
+// events are loaded.
+public:
+  THaEpicsSnapshot() : fEvent(0) {}
+  virtual ~THaEpicsSnapshot() {}
+  Int_t  GetEvent() const { return fEvent; }
+  UInt_t GetSize() const  { return fChan.size(); }
+  const EpicsChan& At(UInt_t i) const { return fChan[i]; }
+  const EpicsChan* Find(const char* tag) const;   // 0 if not loaded
+  Double_t    GetData(const char* tag) const;
+  std::string GetString(const char* tag) const;
+  Double_t    GetTimeStamp(const char* tag) const;
+
+private:
+  friend class THaEpics;
+  Int_t fEvent;                   // Event number asked for
+  std::vector<EpicsChan> fChan;   // Nearest sample of each channel, by tag
+
+  ClassDef(THaEpicsSnapshot,0)  // EPICS data of all channels at one event
+};
+
 class THaEpics {
 
 public:
@@ -63,15 +86,18 @@ public:
 // Get tagged string value nearest 'event'
    std::string GetString (const char* tag, int event=0) const;
    Double_t GetTimeStamp(const char* tag, int event=0) const;
+// Get all channels nearest 'event'
+   void GetSnapshot(int event, THaEpicsSnapshot& snap) const;
    int LoadData (const int* evbuffer, int event=0);  // load the data
    Bool_t IsLoaded(const char* tag) const;
    void Print();
 
 private:
 
+// Samples of each tag, sorted by event number
    std::map< std::string, std::vector<EpicsChan> > epicsData;
-   std::vector<EpicsChan> GetChan(const char *tag) const;
-   Int_t FindEvent(const std::vector<EpicsChan> ep, int event) const;
+   const std::vector<EpicsChan>* GetChan(const char *tag) const;
+   Int_t FindEvent(const std::vector<EpicsChan>& ep, int event) const;
 
    ClassDef(THaEpics,0)  // EPICS data 
 
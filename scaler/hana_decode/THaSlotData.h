@@ -15,6 +15,17 @@
 //   hit counters are zero'd each event, not the data 
 //   arrays, see below.
 //
+//   If define() is given a maximum number of hits per channel
+//   (from the crate map, for modules where the hardware has
+//   such a limit), all arrays of the slot are placed in one
+//   contiguous block sized once, and each channel gets a fixed
+//   range of that many entries in dataindex.  loadData then
+//   never moves or grows anything, and clearEvent only resets
+//   the counters of the channels that were hit.  A channel with
+//   more hits than that switches the slot to the growing layout
+//   (no data are lost).  Without a maximum, the per-channel
+//   ranges grow on demand as before.
+//
 //   author  Robert Michaels (rom@jlab.org)
 //
 /////////////////////////////////////////////////////////////////////
@@ -32,6 +43,9 @@ public:
        static const int DEFNDATA; // Default number of data words
        static const int DEFNHITCHAN; // Default number of hits per channel
 
+       // Device types for the typed loadData
+       enum EDevType { kUnknownDev = 0, kAdc, kTdc, kScaler, kRegister };
+
        THaSlotData();
        THaSlotData(int crate, int slot);
        virtual ~THaSlotData();
@@ -47,14 +61,21 @@ public:
        int getSlot()  const { return slot; }
        void clearEvent();                   // clear event counters
        int loadData(const char* type, int chan, int dat, int raw);
+       int loadData(EDevType type, int chan, int dat, int raw);
        void define(int crate, int slot, UShort_t nchan=DEFNCHAN, 
-		   UShort_t ndata=DEFNDATA, UShort_t nhitperchan=DEFNHITCHAN );// Define crate, slot
+		   UShort_t ndata=DEFNDATA, UShort_t nhitperchan=DEFNHITCHAN,
+		   UShort_t maxhitperchan=0 );// Define crate, slot
+       bool isFixedStride() const { return arena != 0; }
+       static const char* devTypeName(EDevType type);
        void print() const;
        int compressdataindex(int numidx); 
 
 private:
 
- 
+       int  loadHit(int chan, int dat, int raw);
+       void freeArrays();
+       void toGrowing();
+
        int crate;
        int slot;
        TString device;
@@ -76,6 +97,8 @@ private:
        UShort_t maxd;        // Max number of data words per event
        UShort_t allocd;      // Allocated size of data arrays
        UShort_t alloci;      // Allocated size of dataindex array
+       UShort_t stride;      // Fixed entries per channel in dataindex, 0 = growing
+       int* arena;           // Single block holding all arrays if stride > 0
 
        ClassDef(THaSlotData,0)   //  Data in one slot of fastbus, vme, camac
 };
@@ -154,6 +177,9 @@ void THaSlotData::clearEvent() {
 inline  
 int THaSlotData::compressdataindex(int numidx) {
 
+  // nothing to do for the fixed ranges of the fixed-stride layout
+  if (stride) return 0;
+
   // first check if it is more favourable to expand it, or to reshuffle
   if (firstfreedataidx+numidx>=alloci){
     if (((numholesdataidx/alloci)>0.5)&&(numholesdataidx>numidx)) {
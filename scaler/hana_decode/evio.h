@@ -15,12 +15,21 @@ typedef struct evfilestruct {
   int magic;
   int evnum;         /* last events with evnum so far */
   int byte_swapped;
+  int *map;          /* whole file, if memory-mapped for reading */
+  long maplen;       /* length of the mapping in bytes */
+  long mappos;       /* word offset of the next block in map */
+  long mapahead;     /* word offset up to which read-ahead was requested */
+  int mapeof;        /* end of the mapped file reached, like feof */
+  int *swapbuf;      /* scratch for byte-swapped events, reused */
+  int swaplen;       /* length of swapbuf in words */
 } EVFILE;
 
 
 extern int evOpen(const char* filename, const char* flags, int *handle);
 extern int evRead(int handle, int *buffer, int buflen);
 extern int evGetNewBuffer(EVFILE *a);
+extern int evGetPosition(int handle, long *offset);
+extern int evSetPosition(int handle, long offset);
 extern int evWrite(int handle,const int *buffer);
 extern int evFlush(EVFILE *a);
 extern int evIoctl(int handle,char *request,void *argp);
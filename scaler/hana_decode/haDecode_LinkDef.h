@@ -6,8 +6,11 @@
 
 #pragma link C++ class THaCodaData+;
 #pragma link C++ class THaCodaFile+;
+#pragma link C++ class THaCodaIndex+;
+#pragma link C++ class THaCodaIndex::Entry+;
 #pragma link C++ class THaCrateMap+;
 #pragma link C++ class THaEpics+;
+#pragma link C++ class THaEpicsSnapshot+;
 #pragma link C++ class THaEvData+;
 #pragma link C++ class THaFastBusWord+;
 #pragma link C++ class THaHelicity+;